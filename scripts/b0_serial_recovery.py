@@ -0,0 +1,269 @@
+#!/usr/bin/env python3
+# @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+"""
+Host sender for B0 serial recovery (see src/b0_serial_proto.h for the protocol description).
+
+Usage:
+    b0_serial_recovery.py /dev/ttyUSB0 --image s0=s0.bin --image mcuboot_primary=app.hex [--max-baudrate 1000000]
+
+The device enters serial recovery when factory fw recovery is requested (button held for 10 seconds)
+and the images in the external flash can't be used.
+"""
+
+import argparse
+import struct
+import sys
+import time
+import zlib
+
+import serial  # pyserial
+
+SOF = 0xB0
+HDR_FMT = "<BBHH"
+HDR_SIZE = struct.calcsize(HDR_FMT)
+CRC_SIZE = 4
+
+TYPE_HELLO = 0x01
+TYPE_SET_BAUD = 0x02
+TYPE_BEGIN = 0x03
+TYPE_DATA = 0x04
+TYPE_END = 0x05
+TYPE_FINISH = 0x06
+TYPE_ACK = 0x81
+TYPE_NAK = 0x82
+TYPE_HELLO_RSP = 0x83
+
+ERR_SEQ = 0x01
+
+# Slot 0 (provision) is rejected by the device
+SLOTS = {
+    "s0": 1,
+    "s1": 2,
+    "mcuboot_primary": 3,
+    "mcuboot_secondary": 4,
+}
+
+BAUDRATES = (1000000, 921600, 460800, 230400, 115200)
+
+HELLO_TIMEOUT_S = 0.5
+REQ_TIMEOUT_S = 2.0
+END_TIMEOUT_S = 60.0  # the device erases the rest of the slot before replying
+DATA_TIMEOUT_S = 1.0  # the device stalls for a page erase and write (~130 ms) between windows
+MAX_RETRIES = 10
+
+
+class RecoveryError(Exception):
+    pass
+
+
+def load_image(path):
+    if not path.lower().endswith(".hex"):
+        with open(path, "rb") as f:
+            return f.read()
+    segments = {}
+    upper = 0
+    with open(path, "r") as f:
+        for line in f:
+            line = line.strip()
+            if not line.startswith(":"):
+                continue
+            rec = bytes.fromhex(line[1:])
+            if (sum(rec) & 0xFF) != 0:
+                raise RecoveryError(f"{path}: checksum error in line: {line}")
+            length, addr, rec_type = rec[0], (rec[1] << 8) | rec[2], rec[3]
+            data = rec[4 : 4 + length]
+            if rec_type == 0x00:
+                segments[upper + addr] = data
+            elif rec_type == 0x02:
+                upper = int.from_bytes(data, "big") << 4
+            elif rec_type == 0x04:
+                upper = int.from_bytes(data, "big") << 16
+            elif rec_type == 0x01:
+                break
+    if not segments:
+        raise RecoveryError(f"{path}: no data")
+    base = min(segments)
+    end = max(addr + len(data) for addr, data in segments.items())
+    img = bytearray(b"\xff" * (end - base))
+    for addr, data in segments.items():
+        img[addr - base : addr - base + len(data)] = data
+    return bytes(img)
+
+
+class Link:
+    def __init__(self, port, baudrate):
+        self.ser = serial.Serial(port, baudrate, timeout=0)
+        self.rx_buf = bytearray()
+        self.req_seq = 0
+
+    def set_baudrate(self, baudrate):
+        self.ser.flush()
+        self.ser.baudrate = baudrate
+        self.ser.reset_input_buffer()
+        self.rx_buf.clear()
+
+    def send(self, frame_type, seq, payload=b""):
+        body = struct.pack(HDR_FMT, SOF, frame_type, seq, len(payload))[1:] + payload
+        crc = zlib.crc32(body) & 0xFFFFFFFF
+        self.ser.write(bytes([SOF]) + body + struct.pack("<I", crc))
+
+    def _parse(self):
+        while True:
+            idx = self.rx_buf.find(bytes([SOF]))
+            if idx < 0:
+                self.rx_buf.clear()
+                return None
+            del self.rx_buf[:idx]
+            if len(self.rx_buf) < HDR_SIZE:
+                return None
+            _, frame_type, seq, length = struct.unpack_from(HDR_FMT, self.rx_buf)
+            frame_len = HDR_SIZE + length + CRC_SIZE
+            if len(self.rx_buf) < frame_len:
+                return None
+            body = bytes(self.rx_buf[1 : HDR_SIZE + length])
+            (crc,) = struct.unpack_from("<I", self.rx_buf, HDR_SIZE + length)
+            if crc != (zlib.crc32(body) & 0xFFFFFFFF):
+                del self.rx_buf[:1]  # false SOF or damaged frame, resync
+                continue
+            del self.rx_buf[:frame_len]
+            return frame_type, seq, body[HDR_SIZE - 1 :]
+
+    def recv(self, timeout):
+        deadline = time.monotonic() + timeout
+        while True:
+            frame = self._parse()
+            if frame is not None:
+                return frame
+            remaining = deadline - time.monotonic()
+            if remaining <= 0:
+                return None
+            self.ser.timeout = min(remaining, 0.05)
+            self.rx_buf += self.ser.read(max(1, self.ser.in_waiting))
+
+    def drain(self, timeout=0.1):
+        while self.recv(timeout) is not None:
+            pass
+
+    def request(self, frame_type, payload=b"", timeout=REQ_TIMEOUT_S, retries=MAX_RETRIES):
+        for _ in range(retries):
+            self.req_seq = (self.req_seq + 1) & 0xFFFF
+            self.send(frame_type, self.req_seq, payload)
+            deadline = time.monotonic() + timeout
+            while True:
+                frame = self.recv(max(0.0, deadline - time.monotonic()))
+                if frame is None:
+                    break
+                rsp_type, seq, rsp_payload = frame
+                if seq != self.req_seq or rsp_type not in (TYPE_ACK, TYPE_NAK, TYPE_HELLO_RSP):
+                    continue  # late response to a previous request or to DATA
+                if rsp_type == TYPE_NAK:
+                    raise RecoveryError(f"request 0x{frame_type:02x} rejected, error 0x{rsp_payload[0]:02x}")
+                return rsp_payload
+        raise RecoveryError(f"no response to request 0x{frame_type:02x}")
+
+
+def connect(link, max_baudrate, wait_s):
+    deadline = time.monotonic() + wait_s
+    while True:
+        try:
+            rsp = link.request(TYPE_HELLO, timeout=HELLO_TIMEOUT_S, retries=1)
+            break
+        except RecoveryError:
+            if time.monotonic() >= deadline:
+                raise RecoveryError("device does not respond")
+    version, window, chunk_size, dev_max_baudrate = struct.unpack("<BBHI", rsp[:8])
+    print(f"Connected: protocol v{version}, window {window}, chunk {chunk_size}, max {dev_max_baudrate} baud")
+
+    initial = link.ser.baudrate
+    for baudrate in BAUDRATES:
+        if baudrate > min(max_baudrate, dev_max_baudrate) or baudrate <= initial:
+            continue
+        link.request(TYPE_SET_BAUD, struct.pack("<I", baudrate))
+        link.set_baudrate(baudrate)
+        time.sleep(0.05)
+        try:
+            link.request(TYPE_HELLO, timeout=HELLO_TIMEOUT_S, retries=3)
+            print(f"Switched to {baudrate} baud")
+            break
+        except RecoveryError:
+            # The device falls back to the default baudrate when it receives nothing at the new one
+            link.set_baudrate(initial)
+            time.sleep(3.0)
+            link.request(TYPE_HELLO)
+    return window, chunk_size
+
+
+def send_image(link, slot, img, window, chunk_size):
+    num_chunks = (len(img) + chunk_size - 1) // chunk_size
+    link.request(TYPE_BEGIN, struct.pack("<BII", SLOTS[slot], len(img), zlib.crc32(img) & 0xFFFFFFFF))
+
+    started = time.monotonic()
+    base = 0  # first unacknowledged chunk
+    next_seq = 0
+    retries = 0
+    num_retransmits = 0
+    while base < num_chunks:
+        while next_seq < num_chunks and next_seq < base + window:
+            link.send(TYPE_DATA, next_seq, img[next_seq * chunk_size : (next_seq + 1) * chunk_size])
+            next_seq += 1
+        frame = link.recv(DATA_TIMEOUT_S)
+        if frame is None:
+            retries += 1
+            if retries > MAX_RETRIES:
+                raise RecoveryError(f"{slot}: no acknowledgement for chunk {base}")
+            num_retransmits += next_seq - base
+            next_seq = base  # go-back-N
+            continue
+        frame_type, seq, payload = frame
+        if frame_type == TYPE_ACK:
+            if seq > base:
+                base = seq
+                next_seq = max(next_seq, base)
+                retries = 0
+                print(f"\r{slot}: {min(base * chunk_size, len(img))}/{len(img)} bytes", end="", flush=True)
+        elif frame_type == TYPE_NAK:
+            if payload[:1] != bytes([ERR_SEQ]):
+                raise RecoveryError(f"{slot}: chunk {seq} rejected, error 0x{payload[0]:02x}")
+            base = max(base, seq)
+            num_retransmits += next_seq - base
+            next_seq = base
+
+    link.drain()  # duplicate ACKs of retransmitted chunks
+    link.request(TYPE_END, timeout=END_TIMEOUT_S, retries=1)
+    duration = time.monotonic() - started
+    print(f"\r{slot}: {len(img)} bytes in {duration:.1f} s ({len(img) / duration / 1024:.1f} KiB/s), "
+          f"{num_retransmits} chunks retransmitted")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Send images to B0 serial recovery")
+    parser.add_argument("port", help="serial port, e.g. /dev/ttyUSB0")
+    parser.add_argument("--image", action="append", required=True, metavar="SLOT=FILE",
+                        help=f"image for the slot ({', '.join(SLOTS)}), .bin or .hex")
+    parser.add_argument("--baudrate", type=int, default=115200, help="initial baudrate of the device")
+    parser.add_argument("--max-baudrate", type=int, default=BAUDRATES[0], help="the highest baudrate to try")
+    parser.add_argument("--wait", type=float, default=60.0, help="seconds to wait for the device")
+    args = parser.parse_args()
+
+    images = []
+    for item in args.image:
+        slot, _, path = item.partition("=")
+        if slot not in SLOTS or not path:
+            parser.error(f"invalid --image argument: {item}")
+        images.append((slot, load_image(path)))
+
+    link = Link(args.port, args.baudrate)
+    try:
+        window, chunk_size = connect(link, args.max_baudrate, args.wait)
+        for slot, img in images:
+            send_image(link, slot, img, window, chunk_size)
+        link.request(TYPE_FINISH)
+    except RecoveryError as e:
+        print(f"\nERROR: {e}", file=sys.stderr)
+        return 1
+    print("Done, the device reboots")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,138 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "b0_checkpoint.h"
+#include <stddef.h>
+#include <stdbool.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/crc.h>
+
+LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
+
+#define B0_CHECKPOINT_LOG_INTERVAL_MS (1000U)
+
+static uint32_t g_checkpoint_log_timestamp;
+static bool     g_checkpoint_is_logged;
+static bool     g_checkpoint_is_active;
+
+static bool
+b0_checkpoint_is_valid(const b0_checkpoint_t* const p_checkpoint)
+{
+    return (B0_CHECKPOINT_MAGIC == p_checkpoint->magic)
+           && (p_checkpoint->crc32 == crc32_ieee((const uint8_t*)p_checkpoint, offsetof(b0_checkpoint_t, crc32)));
+}
+
+static const char*
+b0_checkpoint_op_to_str(const b0_checkpoint_op_e op)
+{
+    switch (op)
+    {
+        case B0_CHECKPOINT_OP_ERASE:
+            return "Erase";
+        case B0_CHECKPOINT_OP_WRITE:
+            return "Write";
+        case B0_CHECKPOINT_OP_VERIFY:
+            return "Verify";
+        case B0_CHECKPOINT_OP_ERASE_EXT:
+            return "Erase ext";
+        case B0_CHECKPOINT_OP_DONE:
+            return "Done";
+        case B0_CHECKPOINT_OP_FAILED:
+            return "Failed";
+        default:
+            return "None";
+    }
+}
+
+static bool
+b0_checkpoint_is_finished(const b0_checkpoint_t* const p_checkpoint)
+{
+    return (B0_CHECKPOINT_OP_DONE == p_checkpoint->op) || (B0_CHECKPOINT_OP_FAILED == p_checkpoint->op);
+}
+
+static void
+b0_checkpoint_store(
+    b0_checkpoint_t* const   p_checkpoint,
+    const b0_checkpoint_op_e op,
+    const uint8_t            fa_id,
+    const uint32_t           offset)
+{
+    p_checkpoint->seq_num += 1;
+    p_checkpoint->op        = (uint8_t)op;
+    p_checkpoint->fa_id     = fa_id;
+    p_checkpoint->offset    = offset;
+    p_checkpoint->uptime_ms = k_uptime_get_32();
+    p_checkpoint->crc32     = crc32_ieee((const uint8_t*)p_checkpoint, offsetof(b0_checkpoint_t, crc32));
+}
+
+uint8_t
+b0_checkpoint_begin(void)
+{
+    b0_checkpoint_t* const p_checkpoint = &b0_retained_get()->checkpoint;
+
+    uint8_t resume_fa_id = B0_CHECKPOINT_FA_ID_NONE;
+    if (b0_checkpoint_is_valid(p_checkpoint) && !b0_checkpoint_is_finished(p_checkpoint))
+    {
+        resume_fa_id = p_checkpoint->fa_id;
+        LOG_WRN(
+            "B0: Previous recovery was interrupted: %s flash area %u, offset 0x%08x",
+            b0_checkpoint_op_to_str((b0_checkpoint_op_e)p_checkpoint->op),
+            p_checkpoint->fa_id,
+            p_checkpoint->offset);
+        if (p_checkpoint->num_resumes < UINT8_MAX)
+        {
+            p_checkpoint->num_resumes += 1;
+        }
+        p_checkpoint->resume_fa_id = resume_fa_id;
+        // Keep the interrupted operation in the record until the resumed recovery reaches it
+        b0_checkpoint_store(
+            p_checkpoint,
+            (b0_checkpoint_op_e)p_checkpoint->op,
+            p_checkpoint->fa_id,
+            p_checkpoint->offset);
+    }
+    else
+    {
+        p_checkpoint->magic        = B0_CHECKPOINT_MAGIC;
+        p_checkpoint->seq_num      = UINT32_MAX; // the first update makes it 0
+        p_checkpoint->num_resumes  = 0;
+        p_checkpoint->resume_fa_id = B0_CHECKPOINT_FA_ID_NONE;
+        b0_checkpoint_store(p_checkpoint, B0_CHECKPOINT_OP_NONE, B0_CHECKPOINT_FA_ID_NONE, 0);
+    }
+    g_checkpoint_is_active = true;
+    return resume_fa_id;
+}
+
+bool
+b0_checkpoint_is_interrupted(void)
+{
+    const b0_checkpoint_t* const p_checkpoint = &b0_retained_get()->checkpoint;
+    return b0_checkpoint_is_valid(p_checkpoint) && !b0_checkpoint_is_finished(p_checkpoint)
+           && (p_checkpoint->num_resumes < B0_CHECKPOINT_MAX_RESUMES);
+}
+
+void
+b0_checkpoint_update(const b0_checkpoint_op_e op, const uint8_t fa_id, const uint32_t offset)
+{
+    if (!g_checkpoint_is_active)
+    {
+        return;
+    }
+    b0_checkpoint_t* const p_checkpoint = &b0_retained_get()->checkpoint;
+    b0_checkpoint_store(p_checkpoint, op, fa_id, offset);
+    if ((B0_CHECKPOINT_OP_DONE == op) || (B0_CHECKPOINT_OP_FAILED == op))
+    {
+        g_checkpoint_is_active = false;
+    }
+    const uint32_t uptime = p_checkpoint->uptime_ms;
+
+    if ((!g_checkpoint_is_logged) || ((uptime - g_checkpoint_log_timestamp) >= B0_CHECKPOINT_LOG_INTERVAL_MS)
+        || !g_checkpoint_is_active)
+    {
+        g_checkpoint_is_logged     = true;
+        g_checkpoint_log_timestamp = uptime;
+        LOG_INF("B0: Progress: %s flash area %u, offset 0x%08x", b0_checkpoint_op_to_str(op), fa_id, offset);
+    }
+}
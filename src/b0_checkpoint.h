@@ -0,0 +1,54 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#if !defined(B0_CHECKPOINT_H)
+#define B0_CHECKPOINT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "b0_retained.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The number of times B0 resumes an interrupted factory fw recovery by itself, e.g. after a watchdog reset loop
+ * the device boots normally and the recovery can be started again with the button. */
+#define B0_CHECKPOINT_MAX_RESUMES (3U)
+
+/**
+ * @brief Start recording the progress of the factory fw recovery (from external flash or over UART).
+ * @note Flash operations outside of the recovery (self-test) are not recorded.
+ *       If the previous recovery was interrupted, its record is continued: num_resumes is incremented
+ *       and resume_fa_id is set to the flash area at which it was interrupted.
+ * @return the flash area at which the previous recovery was interrupted, B0_CHECKPOINT_FA_ID_NONE if it was not.
+ */
+uint8_t
+b0_checkpoint_begin(void);
+
+/**
+ * @brief Store the progress of the factory fw recovery in the retained RAM (see b0_retained.h).
+ * @note It is called between slices of flash operations, the progress is also logged at most once per second.
+ *       It does nothing if the recovery is not in progress. Recording stops with B0_CHECKPOINT_OP_DONE
+ *       or B0_CHECKPOINT_OP_FAILED.
+ * @param op - the current operation.
+ * @param fa_id - the flash area being processed.
+ * @param offset - the offset in the flash area up to which the operation has been completed.
+ */
+void
+b0_checkpoint_update(const b0_checkpoint_op_e op, const uint8_t fa_id, const uint32_t offset);
+
+/**
+ * @brief Check if the last factory fw recovery was interrupted by a reset which has kept the retained RAM
+ *        (pin reset, watchdog, soft reset) and has not been resumed B0_CHECKPOINT_MAX_RESUMES times yet.
+ * @note A power loss clears the retained RAM, so a recovery interrupted by it is not resumed.
+ */
+bool
+b0_checkpoint_is_interrupted(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // B0_CHECKPOINT_H
@@ -10,17 +10,23 @@
 
 #define CONFIG_RUUVI_AIR_GPIO_EXT_FLASH_POWER_ON_PRIORITY 41
 _Static_assert(CONFIG_RUUVI_AIR_GPIO_EXT_FLASH_POWER_ON_PRIORITY > CONFIG_GPIO_INIT_PRIORITY);
+#if !B0_EXT_FLASH_DEFERRED_INIT
 _Static_assert(CONFIG_RUUVI_AIR_GPIO_EXT_FLASH_POWER_ON_PRIORITY < CONFIG_NORDIC_QSPI_NOR_INIT_PRIORITY);
+#endif
 
 static int // NOSONAR: Zephyr init functions must return int
 b0_early_init(void)
 {
     printk("\r\n*** Ruuvi B0 Bootloader ***\r\n");
-#if defined(CONFIG_BOARD_RUUVI_RUUVIAIR_REV_1)
+#if B0_SUPERCAP_ENABLED
     b0_supercap_init();
-#endif // CONFIG_BOARD_RUUVI_RUUVIAIR_REV_1
+#endif // B0_SUPERCAP_ENABLED
     b0_led_init();
+#if !B0_EXT_FLASH_DEFERRED_INIT
+    // The external flash driver is probed during boot, so power must be on before it.
+    // Otherwise it is powered on by b0_ext_flash_activate() only when factory fw recovery is entered.
     b0_ext_flash_power_on(); // Turn on power to external flash memory and sensors
+#endif
     return 0;
 }
 
@@ -3,9 +3,12 @@
  */
 
 #include "b0_ext_flash_power.h"
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
 #include <zephyr/devicetree.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/logging/log.h>
+#include <zephyr/pm/device.h>
 
 LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
 
@@ -21,6 +24,10 @@ static const struct gpio_dt_spec gpio_enable_sensors = GPIO_DT_SPEC_GET(GPIO_ENA
 #error "Overlay for gpio_enable_sensors node not properly defined."
 #endif
 
+#define EXT_FLASH_POWER_UP_DELAY_US 1000
+
+static bool g_is_ext_flash_powered;
+
 void
 b0_ext_flash_power_on(void)
 {
@@ -45,4 +52,79 @@ b0_ext_flash_power_on(void)
 #else
 #error "Unsupported board configuration. CONFIG_BOARD_RUUVI_RUUVIAIR_REV_<X> must be defined."
 #endif
+    g_is_ext_flash_powered = (ret >= 0);
+}
+
+bool
+b0_ext_flash_activate(void)
+{
+    const struct device* const p_dev = DEVICE_DT_GET(B0_EXT_FLASH_NODE);
+    if (device_is_ready(p_dev))
+    {
+        /* After b0_ext_flash_deactivate() the driver is suspended and the flash is not powered. */
+        return g_is_ext_flash_powered;
+    }
+    if (!g_is_ext_flash_powered)
+    {
+        b0_ext_flash_power_on();
+        if (!g_is_ext_flash_powered)
+        {
+            return false;
+        }
+        k_busy_wait(EXT_FLASH_POWER_UP_DELAY_US);
+    }
+#if B0_EXT_FLASH_DEFERRED_INIT
+    LOG_INF("B0: Initialize external flash %s", p_dev->name);
+    const int32_t rc = device_init(p_dev);
+    if (0 != rc)
+    {
+        LOG_ERR("Failed to initialize external flash %s, rc=%d", p_dev->name, rc);
+        return false;
+    }
+#endif // B0_EXT_FLASH_DEFERRED_INIT
+    if (!device_is_ready(p_dev))
+    {
+        LOG_ERR("External flash %s is not ready", p_dev->name);
+        return false;
+    }
+    return true;
+}
+
+bool
+b0_ext_flash_is_active(void)
+{
+    return g_is_ext_flash_powered && device_is_ready(DEVICE_DT_GET(B0_EXT_FLASH_NODE));
+}
+
+void
+b0_ext_flash_deactivate(void)
+{
+    const struct device* const p_dev = DEVICE_DT_GET(B0_EXT_FLASH_NODE);
+    if (!g_is_ext_flash_powered)
+    {
+        return;
+    }
+#if defined(CONFIG_PM_DEVICE)
+    if (device_is_ready(p_dev))
+    {
+        const int32_t rc = pm_device_action_run(p_dev, PM_DEVICE_ACTION_SUSPEND);
+        if ((0 != rc) && (-EALREADY != rc))
+        {
+            LOG_ERR("Failed to suspend external flash %s, rc=%d, keep it powered", p_dev->name, rc);
+            return;
+        }
+    }
+#else
+    LOG_WRN("B0: CONFIG_PM_DEVICE is disabled, keep external flash %s powered", p_dev->name);
+    return;
+#endif // CONFIG_PM_DEVICE
+    LOG_INF("B0: Power off external flash memory");
+    /* The pin is returned to its reset state, in which the power rail is off. */
+    const int32_t ret = gpio_pin_configure_dt(&gpio_enable_sensors, GPIO_DISCONNECTED);
+    if (ret < 0)
+    {
+        LOG_ERR("gpio_pin_configure_dt failed for GPIO_ENABLE_SENSORS, ret=%d", ret);
+        return;
+    }
+    g_is_ext_flash_powered = false;
 }
@@ -5,13 +5,52 @@
 #if !defined(B0_FLASH_POWER_H)
 #define B0_FLASH_POWER_H
 
+#include <stdbool.h>
+#include <zephyr/devicetree.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#if !DT_HAS_CHOSEN(nordic_pm_ext_flash)
+#error "'nordic,pm-ext-flash' devicetree chosen node is not defined"
+#endif
+
+#define B0_EXT_FLASH_NODE DT_CHOSEN(nordic_pm_ext_flash)
+
+/**
+ * @brief Whether the external flash driver is marked with 'zephyr,deferred-init' in the devicetree.
+ * @note If it is not, the driver is probed during boot and the flash must be powered before that,
+ *       so b0_early_init() falls back to powering it on unconditionally.
+ */
+#define B0_EXT_FLASH_DEFERRED_INIT DT_PROP(B0_EXT_FLASH_NODE, zephyr_deferred_init)
+
 void
 b0_ext_flash_power_on(void);
 
+/**
+ * @brief Power on external flash memory and sensors and initialize the external flash driver on demand.
+ * @return true if the external flash device is ready to use.
+ */
+bool
+b0_ext_flash_activate(void);
+
+/**
+ * @brief Check whether the external flash is powered and its driver is initialized, without activating it.
+ * @note It is true during the normal boot only if the driver is not marked with 'zephyr,deferred-init'.
+ */
+bool
+b0_ext_flash_is_active(void);
+
+/**
+ * @brief Suspend the external flash driver and power off external flash memory and sensors.
+ * @note The external flash can't be activated again until the next boot.
+ *       The power stays on if the driver can't be suspended (it requires CONFIG_PM_DEVICE),
+ *       so that the QSPI pins never drive an unpowered flash.
+ */
+void
+b0_ext_flash_deactivate(void);
+
 #ifdef __cplusplus
 }
 #endif
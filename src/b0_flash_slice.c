@@ -0,0 +1,104 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "b0_flash_slice.h"
+#include <errno.h>
+#include <zephyr/device.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/sys/util.h>
+#include <nrfx_nvmc.h>
+#include "zephyr_api.h"
+
+LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
+
+#define B0_FLASH_SLICE_INT_FLASH_DEV DEVICE_DT_GET(DT_CHOSEN(zephyr_flash_controller))
+
+static bool
+b0_flash_slice_is_in_bounds(const struct flash_area* const p_fa, const off_t offset, const size_t len)
+{
+    return (offset >= 0) && (((size_t)offset + len) <= p_fa->fa_size);
+}
+
+int
+b0_flash_slice_erase_page(
+    const struct flash_area* const p_fa,
+    const off_t                     page_offset,
+    const size_t                    page_size,
+    b0_flash_slice_cb_t             cb_on_slice,
+    void* const                     p_ctx)
+{
+    if (!b0_flash_slice_is_in_bounds(p_fa, page_offset, page_size))
+    {
+        return -EINVAL;
+    }
+#if defined(NRF_NVMC_PARTIAL_ERASE_PRESENT)
+    if ((B0_FLASH_SLICE_INT_FLASH_DEV == p_fa->fa_dev) && (nrfx_nvmc_flash_page_size_get() == page_size))
+    {
+        const uint32_t page_addr = (uint32_t)(CONFIG_FLASH_BASE_ADDRESS + p_fa->fa_off + page_offset);
+        if (NRFX_SUCCESS != nrfx_nvmc_page_partial_erase_init(page_addr, B0_FLASH_SLICE_NVMC_ERASE_MS))
+        {
+            LOG_ERR("Failed to start partial erase at address 0x%08x", page_addr);
+            return -EINVAL;
+        }
+        /* Each call stalls the CPU for one slice, pending interrupts are served after it returns. */
+        while (!nrfx_nvmc_page_partial_erase_continue())
+        {
+            if (NULL != cb_on_slice)
+            {
+                cb_on_slice(p_fa, page_offset, p_ctx);
+            }
+        }
+        return 0;
+    }
+#endif
+    return flash_area_erase(p_fa, page_offset, page_size);
+}
+
+int
+b0_flash_slice_erase_range(
+    const struct flash_area* const p_fa,
+    const off_t                     offset,
+    const size_t                    len,
+    b0_flash_slice_cb_t             cb_on_slice,
+    void* const                     p_ctx)
+{
+    if (!b0_flash_slice_is_in_bounds(p_fa, offset, len))
+    {
+        return -EINVAL;
+    }
+    off_t       cur_offset = offset;
+    const off_t end_offset = offset + (off_t)len;
+    while (cur_offset < end_offset)
+    {
+        const off_t addr      = p_fa->fa_off + cur_offset;
+        size_t      slice_len = B0_FLASH_SLICE_EXT_BLOCK_SIZE;
+        if ((0 != (addr % B0_FLASH_SLICE_EXT_BLOCK_SIZE)) || ((size_t)(end_offset - cur_offset) < slice_len))
+        {
+            /* Erase page by page up to the next block boundary */
+            struct flash_pages_info info = { 0 };
+
+            const zephyr_api_ret_t rc = flash_get_page_info_by_offs(p_fa->fa_dev, addr, &info);
+            if (0 != rc)
+            {
+                LOG_ERR("Failed to get page info at address 0x%08x, rc=%d", (unsigned)addr, rc);
+                return rc;
+            }
+            slice_len = MIN(info.size, (size_t)(end_offset - cur_offset));
+        }
+        const zephyr_api_ret_t rc = flash_area_flatten(p_fa, cur_offset, slice_len);
+        if (0 != rc)
+        {
+            LOG_ERR("Failed to erase address 0x%08x, size 0x%x, rc=%d", (unsigned)addr, (unsigned)slice_len, rc);
+            return rc;
+        }
+        cur_offset += (off_t)slice_len;
+        if (NULL != cb_on_slice)
+        {
+            cb_on_slice(p_fa, cur_offset, p_ctx);
+        }
+    }
+    return 0;
+}
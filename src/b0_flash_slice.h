@@ -0,0 +1,64 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#if !defined(B0_FLASH_SLICE_H)
+#define B0_FLASH_SLICE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <zephyr/storage/flash_map.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The page erase time of nRF52840 is 85 ms, 5 partial erase slices of 17 ms add up to it exactly,
+ * so the partial erase bounds the CPU stall time without reducing the erase throughput. */
+#define B0_FLASH_SLICE_NVMC_ERASE_MS (17U)
+
+/* The largest erase unit of the external flash (64 KiB block erase) */
+#define B0_FLASH_SLICE_EXT_BLOCK_SIZE (64U * 1024U)
+
+/**
+ * @brief Callback which is called between slices of a long flash operation.
+ * @param p_fa - the flash area being erased.
+ * @param offset - the offset in the flash area up to which the operation has been completed.
+ * @param p_ctx - user context.
+ */
+typedef void (*b0_flash_slice_cb_t)(const struct flash_area* const p_fa, const off_t offset, void* const p_ctx);
+
+/**
+ * @brief Erase a page of the flash area.
+ * @note Pages of the internal flash are erased with NVMC partial erase in slices of B0_FLASH_SLICE_NVMC_ERASE_MS,
+ *       the CPU is not stalled for the whole page erase time and interrupts are served between slices.
+ *       Other flash devices are erased with flash_area_erase().
+ * @return 0 on success, negative error code otherwise.
+ */
+int
+b0_flash_slice_erase_page(
+    const struct flash_area* const p_fa,
+    const off_t                     page_offset,
+    const size_t                    page_size,
+    b0_flash_slice_cb_t             cb_on_slice,
+    void* const                     p_ctx);
+
+/**
+ * @brief Erase a range of the flash area (e.g. of the external flash) in slices of at most one erase block.
+ * @note Blocks of B0_FLASH_SLICE_EXT_BLOCK_SIZE are used where the range is aligned to them, so the throughput is
+ *       the same as with a single flash_area_flatten() call, but cb_on_slice runs after every block.
+ * @return 0 on success, negative error code otherwise.
+ */
+int
+b0_flash_slice_erase_range(
+    const struct flash_area* const p_fa,
+    const off_t                     offset,
+    const size_t                    len,
+    b0_flash_slice_cb_t             cb_on_slice,
+    void* const                     p_ctx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // B0_FLASH_SLICE_H
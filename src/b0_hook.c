@@ -4,7 +4,6 @@
 
 #include <stdint.h>
 #include <zephyr/devicetree.h>
-#include <zephyr/linker/devicetree_regions.h>
 #include <zephyr/retention/bootmode.h>
 #include <zephyr/logging/log.h>
 #include <zephyr/sys/__assert.h>
@@ -18,6 +17,15 @@
 #include "b0_segger_rtt.h"
 #include "b0_led_err.h"
 #include "b0_sleep.h"
+#include "b0_ext_flash_power.h"
+#include "b0_qspi_profile.h"
+#include "b0_supercap.h"
+#include "b0_self_test.h"
+#include "b0_serial_recovery.h"
+#include "b0_flash_slice.h"
+#include "b0_checkpoint.h"
+#include "b0_scrub.h"
+#include "b0_retained.h"
 #include "ruuvi_fa_id.h"
 #include "app_version.h"
 #include "ncs_version.h"
@@ -29,10 +37,12 @@
 LOG_MODULE_REGISTER(B0, LOG_LEVEL_INF);
 
 #define BOOT_MODE_TYPE_FACTORY_RESET (0xAC)
+#define BOOT_MODE_TYPE_B0_SELF_TEST  (0xAD)
 
 #define DELAY_ACTIVATE_FACTORY_RECOVERY_MS (10 * 1000)
 
-#define SHARED_NODE DT_NODELABEL(shared_sram)
+/* Upper bound of the time to program a chunk of 256 bytes with NVMC (64 words * 41 us on nRF52840) */
+#define NVMC_WRITE_CHUNK_MS (3U)
 
 _Static_assert(PM_B0_SIZE == PM_B0_EXT_SIZE, "b0 size must be equal to b0_ext size");
 _Static_assert(PM_PROVISION_SIZE == PM_PROVISION_EXT_SIZE, "provision size must be equal to provision_ext size");
@@ -46,16 +56,19 @@ _Static_assert(
     "mcuboot_secondary size must be equal to mcuboot_secondary_ext size");
 
 _Static_assert(PM_S0_SIZE == PM_S1_SIZE, "PM_S0_SIZE must be equal to PM_S1_SIZE");
-/* MCUboot can call crypto functions shared by B0 and this reserved memory area
- * will be used to pass content of MCUboot firmware image for checking B0 signature. */
-static __aligned(4) __attribute__((used)) volatile uint8_t
-    g_reserved_mem[MAX(PM_S0_SIZE, PM_S1_SIZE)] Z_GENERIC_SECTION(LINKER_DT_NODE_REGION_NAME(SHARED_NODE));
+
+/* The flash area at which the interrupted factory fw recovery is resumed, the areas before it are skipped
+ * if they already match the images in the external flash. */
+static uint8_t g_resume_fa_id = B0_CHECKPOINT_FA_ID_NONE;
 
 __NO_RETURN void
 on_factory_fw_recovery_fail(void)
 {
     LOG_ERR("B0: Factory fw recovery failed");
+    b0_checkpoint_update(B0_CHECKPOINT_OP_FAILED, B0_CHECKPOINT_FA_ID_NONE, 0);
     LOG_INF("B0: Wait until button is released");
+    b0_qspi_profile_restore();
+    b0_supercap_unlock_power_off();
     (void)arch_irq_lock();
     b0_led_stop_blinking();
     b0_led_err_blink_red_led(NUM_RED_LED_BLINKS_ON_FW_RECOVERY_FAIL);
@@ -97,84 +110,170 @@ check_and_handle_button_press(bool* const p_flag_activate_fw_loader)
 }
 
 static bool
-check_img_in_ext_flash(const fa_id_t fa_id, const char* fa_name)
+check_images_in_ext_flash(void)
 {
-    static uint8_t           img_header_buf[FW_INFO_OFFSET4 + sizeof(struct fw_info)];
-    const struct flash_area* p_fa = NULL;
-    int32_t                  rc   = flash_area_open(fa_id, &p_fa);
-    if (0 != rc)
+    if (!btldr_img_op_check_fw_info(FIXED_PARTITION_ID(s0_ext), "s0_ext"))
+    {
+        return false;
+    }
+    if (!btldr_img_op_check_fw_info(FIXED_PARTITION_ID(s1_ext), "s1_ext"))
     {
-        LOG_ERR("Failed to open flash area %d (%s), rc=%d", fa_id, fa_name, rc);
         return false;
     }
-    rc = flash_area_read(p_fa, (off_t)0, img_header_buf, sizeof(img_header_buf));
-    if (rc != 0)
+    if (!btldr_img_op_check_fw_info(FIXED_PARTITION_ID(mcuboot_primary_ext), "mcuboot_primary_ext"))
     {
-        LOG_ERR(
-            "Failed to read flash area %d (%s), address 0x%08x, size=%u, rc=%d",
-            fa_id,
-            fa_name,
-            (unsigned)p_fa->fa_off,
-            sizeof(img_header_buf),
-            rc);
         return false;
     }
-    const struct fw_info* const p_img_info = fw_info_find((uint32_t)img_header_buf);
-    if (NULL == p_img_info)
+    if (!btldr_img_op_check_fw_info(FIXED_PARTITION_ID(mcuboot_secondary_ext), "mcuboot_secondary_ext"))
     {
-        LOG_ERR("Failed to find fw_info for image in flash area %d (%s)", fa_id, fa_name);
         return false;
     }
-    LOG_INF("Check image in ext flash area %d (%s): OK", fa_id, fa_name);
     return true;
 }
 
 static bool
-check_images_in_ext_flash(void)
+is_img_resumed_and_matching(const btldr_img_op_job_t* const p_job)
 {
-    if (!check_img_in_ext_flash(FIXED_PARTITION_ID(s0_ext), "s0_ext"))
+    if (B0_CHECKPOINT_FA_ID_NONE == g_resume_fa_id)
     {
         return false;
     }
-    if (!check_img_in_ext_flash(FIXED_PARTITION_ID(s1_ext), "s1_ext"))
+    if (p_job->fa_id_dst == g_resume_fa_id)
     {
+        g_resume_fa_id = B0_CHECKPOINT_FA_ID_NONE;
         return false;
     }
-    if (!check_img_in_ext_flash(FIXED_PARTITION_ID(mcuboot_primary_ext), "mcuboot_primary_ext"))
+    if (!btldr_img_op_cmp(p_job->fa_id_dst, p_job->fa_id_src))
     {
         return false;
     }
-    if (!check_img_in_ext_flash(FIXED_PARTITION_ID(mcuboot_secondary_ext), "mcuboot_secondary_ext"))
+    LOG_INF("B0: Resume: %s already matches %s, skip it", p_job->p_fa_dst_name, p_job->p_fa_src_name);
+    return true;
+}
+
+static bool
+copy_imgs_from_ext_flash_to_int_flash(void)
+{
+    /* Images which are adjacent both in the internal and in the external flash are streamed as one run. */
+    static const btldr_img_op_job_t g_recovery_jobs[] = {
+        { FIXED_PARTITION_ID(provision), "provision", FIXED_PARTITION_ID(provision_ext), "provision_ext", false },
+        { FIXED_PARTITION_ID(s0), "s0", FIXED_PARTITION_ID(s0_ext), "s0_ext", false },
+        { FIXED_PARTITION_ID(s1), "s1", FIXED_PARTITION_ID(s1_ext), "s1_ext", false },
+        { FIXED_PARTITION_ID(mcuboot_primary),
+          "mcuboot_primary",
+          FIXED_PARTITION_ID(mcuboot_primary_ext),
+          "mcuboot_primary_ext",
+          false },
+        { FIXED_PARTITION_ID(mcuboot_secondary),
+          "mcuboot_secondary",
+          FIXED_PARTITION_ID(mcuboot_secondary_ext),
+          "mcuboot_secondary_ext",
+          false },
+    };
+    _Static_assert(ARRAY_SIZE(g_recovery_jobs) <= BTLDR_IMG_OP_MAX_JOBS, "Too many recovery jobs");
+    btldr_img_op_job_t jobs[ARRAY_SIZE(g_recovery_jobs)];
+    uint32_t           num_jobs = 0;
+
+    for (uint32_t i = 0; i < ARRAY_SIZE(g_recovery_jobs); ++i)
     {
+        const btldr_img_op_job_t* const p_job = &g_recovery_jobs[i];
+        LOG_INF(
+            "B0: Copy image from external flash to internal flash: %d (%s) -> %d (%s)",
+            p_job->fa_id_src,
+            p_job->p_fa_src_name,
+            p_job->fa_id_dst,
+            p_job->p_fa_dst_name);
+        if (!is_img_resumed_and_matching(p_job))
+        {
+            jobs[num_jobs] = *p_job;
+            num_jobs += 1;
+        }
+    }
+
+    if (!btldr_img_op_copy_and_verify_multi(jobs, num_jobs))
+    {
+        for (uint32_t i = 0; i < num_jobs; ++i)
+        {
+            if (!jobs[i].is_verified)
+            {
+                LOG_ERR(
+                    "B0: Verification failed after copying image from external flash to internal flash for %s",
+                    jobs[i].p_fa_dst_name);
+            }
+        }
         return false;
     }
     return true;
 }
 
-static bool
-copy_img_from_ext_flash_to_int_flash(
-    const fa_id_t     fa_id_src,
-    const char* const p_fa_src_name,
-    const fa_id_t     fa_id_dst,
-    const char* const p_fa_dst_name)
+void
+btldr_img_op_on_verify_begin(void)
 {
-    LOG_INF(
-        "B0: Copy image from external flash to internal flash: %d (%s) -> %d (%s)",
-        fa_id_src,
-        p_fa_src_name,
-        fa_id_dst,
-        p_fa_dst_name);
+    b0_qspi_profile_set_safe_mode(true);
+}
+
+void
+btldr_img_op_on_verify_end(void)
+{
+    b0_qspi_profile_set_safe_mode(false);
+}
+
+bool
+btldr_img_op_on_verify_mismatch(void)
+{
+    /* The page is rewritten with the devicetree settings which are used during the verification,
+     * the next images are copied with a slower profile. */
+    (void)b0_qspi_profile_downshift();
+    return true;
+}
+
+void
+btldr_img_op_on_page_done(void)
+{
+    b0_supercap_on_page_boundary();
+}
 
-    btldr_img_op_copy(fa_id_dst, fa_id_src);
+static void
+on_int_flash_erase_slice(const struct flash_area* const p_fa, const off_t offset, void* const p_ctx)
+{
+    ARG_UNUSED(p_ctx);
+    b0_checkpoint_update(B0_CHECKPOINT_OP_ERASE, p_fa->fa_id, (uint32_t)offset);
+    b0_supercap_on_slice(B0_FLASH_SLICE_NVMC_ERASE_MS);
+}
 
-    if (!btldr_img_op_cmp(fa_id_dst, fa_id_src))
+int
+btldr_img_op_erase_page(const struct flash_area* const p_fa, const off_t page_offset, const size_t page_size)
+{
+    return b0_flash_slice_erase_page(p_fa, page_offset, page_size, &on_int_flash_erase_slice, NULL);
+}
+
+void
+btldr_img_op_on_slice(const btldr_img_op_stage_e stage, const struct flash_area* const p_fa, const off_t offset)
+{
+    b0_checkpoint_op_e op = B0_CHECKPOINT_OP_NONE;
+    switch (stage)
     {
-        LOG_ERR(
-            "B0: Verification failed after copying image from external flash to internal flash for %s",
-            p_fa_dst_name);
-        return false;
+        case BTLDR_IMG_OP_STAGE_ERASE:
+            op = B0_CHECKPOINT_OP_ERASE;
+            break;
+        case BTLDR_IMG_OP_STAGE_WRITE:
+            op = B0_CHECKPOINT_OP_WRITE;
+            break;
+        case BTLDR_IMG_OP_STAGE_VERIFY:
+            op = B0_CHECKPOINT_OP_VERIFY;
+            break;
+        default:
+            break;
     }
-    return true;
+    b0_checkpoint_update(op, p_fa->fa_id, (uint32_t)offset);
+    b0_supercap_on_slice(NVMC_WRITE_CHUNK_MS);
+}
+
+static void
+on_ext_flash_erase_slice(const struct flash_area* const p_fa, const off_t offset, void* const p_ctx)
+{
+    ARG_UNUSED(p_ctx);
+    b0_checkpoint_update(B0_CHECKPOINT_OP_ERASE_EXT, p_fa->fa_id, (uint32_t)offset);
 }
 
 static bool
@@ -197,7 +296,7 @@ flash_erase(const fa_id_t fa_id, const char* const p_fa_name)
         p_fa->fa_dev->name,
         p_fa->fa_size);
 
-    rc = flash_area_flatten(p_fa, 0, p_fa->fa_size);
+    rc = b0_flash_slice_erase_range(p_fa, 0, p_fa->fa_size, &on_ext_flash_erase_slice, NULL);
     if (rc < 0)
     {
         LOG_ERR("Erasing flash area %d failed, rc=%d", fa_id, rc);
@@ -211,51 +310,10 @@ flash_erase(const fa_id_t fa_id, const char* const p_fa_name)
 }
 
 static __NO_RETURN void
-factory_fw_recovery(void)
+factory_fw_recovery_finish(void)
 {
-    b0_led_start_blinking_red_green_500ms();
-
-    if (!check_images_in_ext_flash())
-    {
-        on_factory_fw_recovery_fail();
-    }
-    if (!copy_img_from_ext_flash_to_int_flash(
-            FIXED_PARTITION_ID(provision_ext),
-            "provision_ext",
-            FIXED_PARTITION_ID(provision),
-            "provision"))
-    {
-        on_factory_fw_recovery_fail();
-    }
-    if (!copy_img_from_ext_flash_to_int_flash(FIXED_PARTITION_ID(s0_ext), "s0_ext", FIXED_PARTITION_ID(s0), "s0"))
-    {
-        on_factory_fw_recovery_fail();
-    }
-    if (!copy_img_from_ext_flash_to_int_flash(FIXED_PARTITION_ID(s1_ext), "s1_ext", FIXED_PARTITION_ID(s1), "s1"))
-    {
-        on_factory_fw_recovery_fail();
-    }
-    if (!copy_img_from_ext_flash_to_int_flash(
-            FIXED_PARTITION_ID(mcuboot_primary_ext),
-            "mcuboot_primary_ext",
-            FIXED_PARTITION_ID(mcuboot_primary),
-            "mcuboot_primary"))
-    {
-        on_factory_fw_recovery_fail();
-    }
-    if (!copy_img_from_ext_flash_to_int_flash(
-            FIXED_PARTITION_ID(mcuboot_secondary_ext),
-            "mcuboot_secondary_ext",
-            FIXED_PARTITION_ID(mcuboot_secondary),
-            "mcuboot_secondary"))
-    {
-        on_factory_fw_recovery_fail();
-    }
-    if (!flash_erase(PM_ID(ext_flash_userspace), "ext_flash_userspace"))
-    {
-        on_factory_fw_recovery_fail();
-    }
     LOG_INF("B0: Factory firmware recovered successfully");
+    b0_checkpoint_update(B0_CHECKPOINT_OP_DONE, B0_CHECKPOINT_FA_ID_NONE, 0);
 
     zephyr_api_ret_t rc = bootmode_set(BOOT_MODE_TYPE_FACTORY_RESET);
     if (0 != rc)
@@ -282,6 +340,55 @@ factory_fw_recovery(void)
     sys_reboot(SYS_REBOOT_COLD);
 }
 
+/**
+ * @brief Receive the images over UART when the factory images in the external flash can't be used.
+ * @note The external flash (including ext_flash_userspace) is not touched in this case,
+ *       the application performs the factory reset after reboot.
+ */
+static __NO_RETURN void
+factory_fw_recovery_via_serial(void)
+{
+    if (!B0_SERIAL_RECOVERY_ENABLED)
+    {
+        on_factory_fw_recovery_fail();
+    }
+    LOG_WRN("B0: Factory images in external flash are not usable, switch to serial recovery");
+    if (!b0_serial_recovery_run())
+    {
+        on_factory_fw_recovery_fail();
+    }
+    factory_fw_recovery_finish();
+}
+
+static __NO_RETURN void
+factory_fw_recovery(void)
+{
+    g_resume_fa_id = b0_checkpoint_begin();
+    b0_led_start_blinking_red_green_500ms();
+
+    if (!b0_ext_flash_activate())
+    {
+        factory_fw_recovery_via_serial();
+    }
+    if (!check_images_in_ext_flash())
+    {
+        factory_fw_recovery_via_serial();
+    }
+    b0_qspi_profile_enter_fast(FIXED_PARTITION_ID(s0_ext));
+    b0_supercap_lock_power_off();
+    if (!copy_imgs_from_ext_flash_to_int_flash())
+    {
+        on_factory_fw_recovery_fail();
+    }
+    b0_qspi_profile_restore();
+    b0_supercap_unlock_power_off();
+    if (!flash_erase(PM_ID(ext_flash_userspace), "ext_flash_userspace"))
+    {
+        on_factory_fw_recovery_fail();
+    }
+    factory_fw_recovery_finish();
+}
+
 int // NOSONAR: Zephyr API
 soc_late_init_hook(void)
 {
@@ -302,12 +409,30 @@ soc_late_init_hook(void)
 
     b0_segger_rtt_check_data_location_and_size();
 
+    b0_retained_init();
+
+    if (b0_checkpoint_is_interrupted())
+    {
+        LOG_WRN("B0: Factory fw recovery was interrupted by reset, resume it");
+        factory_fw_recovery();
+    }
+
+    if (bootmode_check(BOOT_MODE_TYPE_B0_SELF_TEST) > 0)
+    {
+        LOG_INF("B0: Activate recovery self-test mode");
+        (void)bootmode_clear();
+        b0_self_test_run();
+    }
+
     bool flag_activate_fw_loader = false;
     if (check_and_handle_button_press(&flag_activate_fw_loader))
     {
         LOG_INF("B0: Activate factory fw recovery mode");
         factory_fw_recovery();
     }
+
+    b0_scrub_run();
+
     if (flag_activate_fw_loader)
     {
         LOG_INF("B0: Activate fw_loader mode");
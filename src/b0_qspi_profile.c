@@ -0,0 +1,191 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "b0_qspi_profile.h"
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <nrfx_qspi.h>
+#include <hal/nrf_qspi.h>
+
+LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
+
+#define QSPI_PROFILE_REF_BUF_SIZE 256
+
+typedef struct b0_qspi_profile_t
+{
+    nrf_qspi_frequency_t sck_freq;
+    nrf_qspi_readoc_t    readoc;
+    const char*          p_name;
+} b0_qspi_profile_t;
+
+/* Profiles used during factory fw recovery, ordered from the fastest to the slowest.
+ * The settings from the devicetree are used as the last (safest) step. */
+static const b0_qspi_profile_t g_qspi_profiles[] = {
+    { NRF_QSPI_FREQ_DIV1, NRF_QSPI_READOC_READ4IO, "32 MHz, READ4IO" },
+    { NRF_QSPI_FREQ_DIV2, NRF_QSPI_READOC_READ4IO, "16 MHz, READ4IO" },
+    { NRF_QSPI_FREQ_DIV2, NRF_QSPI_READOC_READ2IO, "16 MHz, READ2IO" },
+};
+
+#define QSPI_PROFILE_IDX_DEFAULT ARRAY_SIZE(g_qspi_profiles)
+
+static uint32_t g_qspi_profile_idx = QSPI_PROFILE_IDX_DEFAULT;
+static bool     g_is_qspi_safe_mode;
+static bool     g_is_qspi_default_saved;
+static uint32_t g_qspi_default_ifconfig0;
+static uint32_t g_qspi_default_ifconfig1;
+
+static uint32_t
+b0_qspi_profile_get_active_idx(void)
+{
+    return g_is_qspi_safe_mode ? QSPI_PROFILE_IDX_DEFAULT : g_qspi_profile_idx;
+}
+
+static void
+b0_qspi_profile_apply(void)
+{
+    const uint32_t profile_idx = b0_qspi_profile_get_active_idx();
+
+    uint32_t ifconfig0 = g_qspi_default_ifconfig0;
+    uint32_t ifconfig1 = g_qspi_default_ifconfig1;
+    if (profile_idx < QSPI_PROFILE_IDX_DEFAULT)
+    {
+        const b0_qspi_profile_t* const p_profile = &g_qspi_profiles[profile_idx];
+
+        ifconfig0 = (ifconfig0 & ~QSPI_IFCONFIG0_READOC_Msk)
+                    | (((uint32_t)p_profile->readoc << QSPI_IFCONFIG0_READOC_Pos) & QSPI_IFCONFIG0_READOC_Msk);
+        ifconfig1 = (ifconfig1 & ~QSPI_IFCONFIG1_SCKFREQ_Msk)
+                    | (((uint32_t)p_profile->sck_freq << QSPI_IFCONFIG1_SCKFREQ_Pos) & QSPI_IFCONFIG1_SCKFREQ_Msk);
+    }
+    NRF_QSPI->IFCONFIG0 = ifconfig0;
+    NRF_QSPI->IFCONFIG1 = ifconfig1;
+}
+
+static bool
+b0_qspi_profile_read(const struct flash_area* const p_fa, uint8_t* const p_buf, const size_t buf_len)
+{
+    const int32_t rc = flash_area_read(p_fa, 0, p_buf, buf_len);
+    if (0 != rc)
+    {
+        LOG_ERR("Failed to read flash area %d, rc=%d", p_fa->fa_id, rc);
+        return false;
+    }
+    return true;
+}
+
+void
+b0_qspi_profile_enter_fast(const fa_id_t fa_id_ref)
+{
+    static uint8_t ref_buf[QSPI_PROFILE_REF_BUF_SIZE];
+    static uint8_t tmp_buf[QSPI_PROFILE_REF_BUF_SIZE];
+
+    const struct flash_area* p_fa = NULL;
+    if (0 != flash_area_open(fa_id_ref, &p_fa))
+    {
+        LOG_ERR("Failed to open flash area %d", fa_id_ref);
+        return;
+    }
+    if (!b0_qspi_profile_read(p_fa, ref_buf, sizeof(ref_buf)))
+    {
+        flash_area_close(p_fa);
+        return;
+    }
+    if (!g_is_qspi_default_saved)
+    {
+        g_qspi_default_ifconfig0 = NRF_QSPI->IFCONFIG0;
+        g_qspi_default_ifconfig1 = NRF_QSPI->IFCONFIG1;
+        g_is_qspi_default_saved  = true;
+    }
+    g_is_qspi_safe_mode = false;
+
+    for (g_qspi_profile_idx = 0; g_qspi_profile_idx < QSPI_PROFILE_IDX_DEFAULT; ++g_qspi_profile_idx)
+    {
+        b0_qspi_profile_apply();
+        if (b0_qspi_profile_read(p_fa, tmp_buf, sizeof(tmp_buf)) && (0 == memcmp(ref_buf, tmp_buf, sizeof(ref_buf))))
+        {
+            break;
+        }
+        LOG_WRN("QSPI profile %s: reading is not reliable", g_qspi_profiles[g_qspi_profile_idx].p_name);
+    }
+    flash_area_close(p_fa);
+
+    if (g_qspi_profile_idx < QSPI_PROFILE_IDX_DEFAULT)
+    {
+        LOG_INF("B0: Use QSPI profile: %s", g_qspi_profiles[g_qspi_profile_idx].p_name);
+    }
+    else
+    {
+        b0_qspi_profile_apply();
+        LOG_INF("B0: Use default QSPI profile");
+    }
+}
+
+void
+b0_qspi_profile_set_safe_mode(const bool is_safe_mode)
+{
+    const uint32_t prev_profile_idx = b0_qspi_profile_get_active_idx();
+    g_is_qspi_safe_mode             = is_safe_mode;
+    if (b0_qspi_profile_get_active_idx() != prev_profile_idx)
+    {
+        b0_qspi_profile_apply();
+    }
+}
+
+bool
+b0_qspi_profile_downshift(void)
+{
+    if (g_qspi_profile_idx >= QSPI_PROFILE_IDX_DEFAULT)
+    {
+        return false;
+    }
+    g_qspi_profile_idx += 1;
+    b0_qspi_profile_apply();
+    if (g_qspi_profile_idx < QSPI_PROFILE_IDX_DEFAULT)
+    {
+        LOG_WRN("B0: Downshift QSPI profile to %s", g_qspi_profiles[g_qspi_profile_idx].p_name);
+    }
+    else
+    {
+        LOG_WRN("B0: Downshift QSPI profile to default");
+    }
+    return true;
+}
+
+void
+b0_qspi_profile_restore(void)
+{
+    const uint32_t prev_profile_idx = b0_qspi_profile_get_active_idx();
+    g_qspi_profile_idx              = QSPI_PROFILE_IDX_DEFAULT;
+    g_is_qspi_safe_mode             = false;
+    if (prev_profile_idx < QSPI_PROFILE_IDX_DEFAULT)
+    {
+        b0_qspi_profile_apply();
+    }
+}
+
+/* The QSPI NOR driver may re-initialize the peripheral before an operation,
+ * so the active profile is also applied to the configuration passed to nrfx. */
+nrfx_err_t
+__wrap_nrfx_qspi_init( // NOSONAR
+    nrfx_qspi_config_t const* p_config,
+    nrfx_qspi_handler_t       handler,
+    void*                     p_context)
+{
+    extern nrfx_err_t __real_nrfx_qspi_init( // NOSONAR
+        nrfx_qspi_config_t const* p_config,
+        nrfx_qspi_handler_t       handler,
+        void*                     p_context);
+
+    const uint32_t profile_idx = b0_qspi_profile_get_active_idx();
+    if (profile_idx >= QSPI_PROFILE_IDX_DEFAULT)
+    {
+        return __real_nrfx_qspi_init(p_config, handler, p_context);
+    }
+    nrfx_qspi_config_t config = *p_config;
+    config.phy_if.sck_freq    = g_qspi_profiles[profile_idx].sck_freq;
+    config.prot_if.readoc     = g_qspi_profiles[profile_idx].readoc;
+    return __real_nrfx_qspi_init(&config, handler, p_context);
+}
@@ -0,0 +1,49 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#if !defined(B0_QSPI_PROFILE_H)
+#define B0_QSPI_PROFILE_H
+
+#include <stdbool.h>
+#include "ruuvi_fa_id.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Switch QSPI to the fastest clock and read mode which reads the reference area correctly.
+ * @param fa_id_ref - flash area in external flash which is read with the default settings
+ *                    and used as a reference to check every faster profile.
+ */
+void
+b0_qspi_profile_enter_fast(const fa_id_t fa_id_ref);
+
+/**
+ * @brief Temporarily use the settings from the devicetree without forgetting the selected fast profile.
+ * @note It is used to verify the data copied with the fast profile, so that the verification does not
+ *       repeat a read error which has corrupted the copy.
+ * @param is_safe_mode - true to use the devicetree settings, false to return to the selected profile.
+ */
+void
+b0_qspi_profile_set_safe_mode(const bool is_safe_mode);
+
+/**
+ * @brief Switch QSPI to the next slower profile (it is applied after leaving the safe mode).
+ * @return false if the default (devicetree) settings are already selected.
+ */
+bool
+b0_qspi_profile_downshift(void);
+
+/**
+ * @brief Restore the QSPI settings from the devicetree.
+ */
+void
+b0_qspi_profile_restore(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // B0_QSPI_PROFILE_H
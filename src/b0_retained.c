@@ -0,0 +1,26 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "b0_retained.h"
+#include <string.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
+
+void
+b0_retained_init(void)
+{
+    b0_retained_t* const p_retained = b0_retained_get();
+
+    if ((B0_RETAINED_MAGIC == p_retained->hdr.magic) && (B0_RETAINED_SIZE == p_retained->hdr.size)
+        && (B0_RETAINED_VERSION == p_retained->hdr.version))
+    {
+        return;
+    }
+    LOG_INF("B0: Initialize retained data (version %u)", B0_RETAINED_VERSION);
+    memset(p_retained, 0, sizeof(*p_retained));
+    p_retained->hdr.magic   = B0_RETAINED_MAGIC;
+    p_retained->hdr.version = B0_RETAINED_VERSION;
+    p_retained->hdr.size    = B0_RETAINED_SIZE;
+}
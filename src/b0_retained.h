@@ -0,0 +1,192 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#if !defined(B0_RETAINED_H)
+#define B0_RETAINED_H
+
+#include <stdint.h>
+#include <zephyr/devicetree.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define B0_SHARED_SRAM_NODE DT_NODELABEL(shared_sram)
+
+#define B0_RETAINED_MAGIC (0x52524230U) // "0BRR"
+
+/* The size of the retained block is fixed, so its address does not depend on the B0 version.
+ * New members are only appended (taking space from the reserved tail) and each addition increments
+ * B0_RETAINED_VERSION, so the application can check that a member exists before reading it. */
+#define B0_RETAINED_SIZE    (1024U)
+#define B0_RETAINED_VERSION (1U)
+
+#define B0_SELF_TEST_REPORT_MAGIC (0x54534230U) // "0BST"
+
+#define B0_CHECKPOINT_MAGIC (0x50434230U) // "0BCP"
+
+#define B0_CHECKPOINT_FA_ID_NONE (0xFFU)
+
+#define B0_SCRUB_STATE_MAGIC (0x43534230U) // "0BSC"
+
+#define B0_SCRUB_NUM_PARTITIONS (5)
+#define B0_SCRUB_HASH_CTX_SIZE  (256U)
+
+#define B0_SELF_TEST_NUM_PARTITIONS          (5)
+#define B0_SELF_TEST_MAX_MISMATCHES_PER_PART (4)
+
+typedef enum b0_self_test_status_e
+{
+    B0_SELF_TEST_STATUS_NOT_CHECKED = 0,
+    B0_SELF_TEST_STATUS_OK          = 1,
+    B0_SELF_TEST_STATUS_MISMATCH    = 2,
+    B0_SELF_TEST_STATUS_INVALID_IMG = 3,
+    B0_SELF_TEST_STATUS_IO_ERR      = 4,
+} b0_self_test_status_e;
+
+typedef struct b0_self_test_part_res_t
+{
+    uint8_t  fa_id_src;      //!< Flash area ID of the factory image in external flash
+    uint8_t  fa_id_dst;      //!< Flash area ID of the partition in internal flash
+    uint8_t  status;         //!< @ref b0_self_test_status_e
+    uint8_t  num_offsets;    //!< Number of valid entries in mismatch_offsets
+    uint32_t num_mismatches; //!< Total number of mismatching chunks
+    uint32_t size;           //!< Number of bytes compared
+    uint32_t duration_ms;    //!< Time spent on comparing the partition
+    uint32_t bytes_per_sec;  //!< Read throughput of the compare pass
+    uint32_t mismatch_offsets[B0_SELF_TEST_MAX_MISMATCHES_PER_PART];
+} b0_self_test_part_res_t;
+
+/**
+ * @brief Result of the recovery self-test, left in retained RAM for the application.
+ * @note The report is valid only if magic matches and crc32 (CRC-32/IEEE over all preceding fields) is correct.
+ */
+typedef struct b0_self_test_report_t
+{
+    uint32_t                magic;
+    uint32_t                seq_num;           //!< Incremented by B0 on every run of the self-test
+    uint32_t                is_ext_imgs_valid; //!< Result of validation of images in external flash
+    uint32_t                duration_ms;       //!< Total duration of the self-test
+    b0_self_test_part_res_t parts[B0_SELF_TEST_NUM_PARTITIONS];
+    uint32_t                crc32;
+} b0_self_test_report_t;
+
+typedef enum b0_checkpoint_op_e
+{
+    B0_CHECKPOINT_OP_NONE      = 0,
+    B0_CHECKPOINT_OP_ERASE     = 1, //!< Erasing a partition in internal flash
+    B0_CHECKPOINT_OP_WRITE     = 2, //!< Writing a partition in internal flash
+    B0_CHECKPOINT_OP_VERIFY    = 3, //!< Verifying a partition in internal flash
+    B0_CHECKPOINT_OP_ERASE_EXT = 4, //!< Erasing ext_flash_userspace
+    B0_CHECKPOINT_OP_DONE      = 5, //!< Factory fw recovery finished successfully
+    B0_CHECKPOINT_OP_FAILED    = 6, //!< Factory fw recovery failed, it is not resumed
+} b0_checkpoint_op_e;
+
+/**
+ * @brief Progress of the last factory fw recovery (from external flash or over UART),
+ *        updated by B0 between slices of flash operations.
+ * @note The checkpoint is valid only if magic matches and crc32 (CRC-32/IEEE over all preceding fields) is correct.
+ *       If the recovery was interrupted by a reset, it shows how far the recovery got, and B0 resumes it.
+ *       The record of an interrupted recovery is continued rather than overwritten by the resumed one.
+ */
+typedef struct b0_checkpoint_t
+{
+    uint32_t magic;
+    uint32_t seq_num;      //!< Incremented by B0 on every update
+    uint8_t  op;           //!< @ref b0_checkpoint_op_e
+    uint8_t  fa_id;        //!< Flash area being processed
+    uint8_t  num_resumes;  //!< Number of times the interrupted recovery has been resumed
+    uint8_t  resume_fa_id; //!< Flash area at which the recovery was interrupted the last time (0xFF - none)
+    uint32_t offset;       //!< Offset in the flash area up to which the operation has been completed
+    uint32_t uptime_ms;    //!< Uptime at the moment of the update
+    uint32_t crc32;
+} b0_checkpoint_t;
+
+typedef enum b0_scrub_status_e
+{
+    B0_SCRUB_STATUS_NOT_CHECKED = 0,
+    B0_SCRUB_STATUS_OK          = 1,
+    B0_SCRUB_STATUS_MISMATCH    = 2, //!< The digest (or the content for provision_ext) does not match
+    B0_SCRUB_STATUS_INVALID_IMG = 3, //!< The image header or the stored digest is missing
+    B0_SCRUB_STATUS_IO_ERR      = 4,
+} b0_scrub_status_e;
+
+typedef struct b0_scrub_part_res_t
+{
+    uint8_t  fa_id;    //!< Flash area ID of the factory image in external flash
+    uint8_t  status;   //!< @ref b0_scrub_status_e
+    uint16_t reserved;
+    uint32_t pass_num; //!< Number of the pass in which the status was determined
+} b0_scrub_part_res_t;
+
+/**
+ * @brief State of the incremental scrubbing of the factory images in external flash.
+ * @note B0 checks a small slice of the images on every B0_SCRUB_BOOT_INTERVAL-th normal boot
+ *       and continues from the cursor on the next one.
+ *       The state is valid only if magic matches and crc32 (CRC-32/IEEE over all preceding fields) is correct,
+ *       otherwise (e.g. after power-on reset) the scrubbing starts from the beginning.
+ */
+typedef struct b0_scrub_state_t
+{
+    uint32_t            magic;
+    uint32_t            num_passes;        //!< Number of completed passes over all factory images
+    uint32_t            num_failures;      //!< Number of partitions which failed the check since the state was reset
+    uint8_t             part_idx;          //!< Index of the partition being checked
+    uint8_t             num_skipped_boots; //!< Number of boots since the last scrub run
+    uint8_t             reserved[2];
+    uint32_t            offset;            //!< Cursor: offset in the partition up to which it has been checked
+    uint32_t            end_offset;        //!< Offset in the partition at which the check ends (0 - not started)
+    uint32_t            ref_digest_prefix; //!< First bytes of the stored digest, to detect a replaced image
+    b0_scrub_part_res_t parts[B0_SCRUB_NUM_PARTITIONS];
+    uint32_t            hash_ctx[B0_SCRUB_HASH_CTX_SIZE / sizeof(uint32_t)]; //!< Running SHA-256 state (B0 private)
+    uint32_t            crc32;
+} b0_scrub_state_t;
+
+typedef struct b0_retained_hdr_t
+{
+    uint32_t magic;   //!< B0_RETAINED_MAGIC
+    uint16_t version; //!< B0_RETAINED_VERSION of the B0 which has initialized the block
+    uint16_t size;    //!< B0_RETAINED_SIZE
+} b0_retained_hdr_t;
+
+/**
+ * @brief Data retained by B0 for the application across warm resets.
+ * @note It is placed at the end of the shared_sram region, after the area used by MCUboot.
+ *       B0 initializes the header (and clears the block) if the header is not valid.
+ *       Members available since version:
+ *         1 - self_test, checkpoint, scrub
+ */
+typedef union b0_retained_t
+{
+    struct
+    {
+        b0_retained_hdr_t     hdr;
+        b0_self_test_report_t self_test;
+        b0_checkpoint_t       checkpoint;
+        b0_scrub_state_t      scrub;
+    };
+    uint8_t raw[B0_RETAINED_SIZE];
+} b0_retained_t;
+
+_Static_assert(sizeof(b0_retained_t) == B0_RETAINED_SIZE, "b0_retained_t does not fit into B0_RETAINED_SIZE");
+
+#define B0_RETAINED_ADDR (DT_REG_ADDR(B0_SHARED_SRAM_NODE) + DT_REG_SIZE(B0_SHARED_SRAM_NODE) - B0_RETAINED_SIZE)
+
+static inline b0_retained_t*
+b0_retained_get(void)
+{
+    return (b0_retained_t*)B0_RETAINED_ADDR; // NOSONAR: fixed address in shared SRAM
+}
+
+/**
+ * @brief Initialize the header of the retained block, the block is cleared if the header is not valid.
+ */
+void
+b0_retained_init(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // B0_RETAINED_H
@@ -0,0 +1,425 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "b0_scrub.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/util.h>
+#include <flash_map_pm.h>
+#include <fw_info.h>
+#include <fw_info_bare.h>
+#include <bl_crypto.h>
+#include "b0_ext_flash_power.h"
+#include "b0_retained.h"
+#include "ruuvi_fa_id.h"
+#include "zephyr_api.h"
+
+LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
+
+/* Number of bytes checked in one scrub run */
+#if !defined(B0_SCRUB_BYTES_PER_RUN)
+#define B0_SCRUB_BYTES_PER_RUN (8U * 1024U)
+#endif
+
+/* The scrub runs on every B0_SCRUB_BOOT_INTERVAL-th boot, since the external flash has to be powered up for it */
+#if !defined(B0_SCRUB_BOOT_INTERVAL)
+#define B0_SCRUB_BOOT_INTERVAL (4U)
+#endif
+
+_Static_assert((B0_SCRUB_BOOT_INTERVAL >= 1U) && (B0_SCRUB_BOOT_INTERVAL <= 256U), "Invalid B0_SCRUB_BOOT_INTERVAL");
+
+#define B0_SCRUB_CHUNK_SIZE  (4096U)
+#define B0_SCRUB_DIGEST_SIZE (32U)
+
+#define B0_SCRUB_MCUBOOT_IMAGE_MAGIC    (0x96f3b83dU)
+#define B0_SCRUB_MCUBOOT_TLV_INFO_MAGIC (0x6907U)
+#define B0_SCRUB_MCUBOOT_TLV_SHA256     (0x10U)
+
+_Static_assert(sizeof(bl_sha256_ctx_t) <= B0_SCRUB_HASH_CTX_SIZE, "B0_SCRUB_HASH_CTX_SIZE is too small");
+_Static_assert(CONFIG_SB_HASH_LEN == B0_SCRUB_DIGEST_SIZE, "Unsupported hash length");
+
+typedef enum b0_scrub_ref_type_e
+{
+    B0_SCRUB_REF_TYPE_INT_COPY,      //!< Compared with the internal partition, which is never updated in the field
+    B0_SCRUB_REF_TYPE_FW_VALIDATION, //!< SHA-256 from fw_validation_info appended to the B0-signed image
+    B0_SCRUB_REF_TYPE_MCUBOOT_TLV,   //!< SHA-256 from the TLV area of the MCUboot image
+} b0_scrub_ref_type_e;
+
+typedef struct b0_scrub_part_t
+{
+    fa_id_t             fa_id;
+    const char*         p_fa_name;
+    b0_scrub_ref_type_e ref_type;
+    uint32_t            int_addr; //!< Address of the internal partition which the image is intended for
+} b0_scrub_part_t;
+
+typedef struct b0_scrub_ref_t
+{
+    uint32_t start_offset;
+    uint32_t end_offset;
+    uint8_t  digest[B0_SCRUB_DIGEST_SIZE];
+} b0_scrub_ref_t;
+
+typedef struct b0_scrub_mcuboot_hdr_t
+{
+    uint32_t magic;
+    uint32_t load_addr;
+    uint16_t hdr_size;
+    uint16_t protect_tlv_size;
+    uint32_t img_size;
+} b0_scrub_mcuboot_hdr_t;
+
+typedef struct b0_scrub_mcuboot_tlv_t
+{
+    uint16_t type; //!< For the TLV info header it is the magic
+    uint16_t len;  //!< For the TLV info header it is the total size of the TLV area
+} b0_scrub_mcuboot_tlv_t;
+
+static const b0_scrub_part_t g_scrub_parts[B0_SCRUB_NUM_PARTITIONS] = {
+    { FIXED_PARTITION_ID(provision_ext), "provision_ext", B0_SCRUB_REF_TYPE_INT_COPY, PM_PROVISION_ADDRESS },
+    { FIXED_PARTITION_ID(s0_ext), "s0_ext", B0_SCRUB_REF_TYPE_FW_VALIDATION, PM_S0_ADDRESS },
+    { FIXED_PARTITION_ID(s1_ext), "s1_ext", B0_SCRUB_REF_TYPE_FW_VALIDATION, PM_S1_ADDRESS },
+    { FIXED_PARTITION_ID(mcuboot_primary_ext),
+      "mcuboot_primary_ext",
+      B0_SCRUB_REF_TYPE_MCUBOOT_TLV,
+      PM_MCUBOOT_PRIMARY_ADDRESS },
+    { FIXED_PARTITION_ID(mcuboot_secondary_ext),
+      "mcuboot_secondary_ext",
+      B0_SCRUB_REF_TYPE_MCUBOOT_TLV,
+      PM_MCUBOOT_SECONDARY_ADDRESS },
+};
+
+/* The buffer is also used to read the image header, fw_info can be at any of the FW_INFO_OFFSETx */
+static uint8_t          g_scrub_buf[MAX(B0_SCRUB_CHUNK_SIZE, FW_INFO_OFFSET4 + sizeof(struct fw_info))];
+static b0_scrub_state_t g_scrub_state;
+
+static bool
+b0_scrub_is_state_valid(const b0_scrub_state_t* const p_state)
+{
+    return (B0_SCRUB_STATE_MAGIC == p_state->magic) && (p_state->part_idx < B0_SCRUB_NUM_PARTITIONS)
+           && (p_state->crc32 == crc32_ieee((const uint8_t*)p_state, offsetof(b0_scrub_state_t, crc32)));
+}
+
+static void
+b0_scrub_reset_state(b0_scrub_state_t* const p_state)
+{
+    memset(p_state, 0, sizeof(*p_state));
+    p_state->magic = B0_SCRUB_STATE_MAGIC;
+    /* The first boot after the reset of the state runs the scrub. */
+    p_state->num_skipped_boots = (uint8_t)(B0_SCRUB_BOOT_INTERVAL - 1U);
+    for (uint32_t i = 0; i < B0_SCRUB_NUM_PARTITIONS; ++i)
+    {
+        p_state->parts[i].fa_id = (uint8_t)g_scrub_parts[i].fa_id;
+    }
+}
+
+static b0_scrub_status_e
+b0_scrub_get_ref_fw_validation(
+    const struct flash_area* const p_fa,
+    const b0_scrub_part_t* const   p_part,
+    b0_scrub_ref_t* const          p_ref)
+{
+    if (0 != flash_area_read(p_fa, 0, g_scrub_buf, FW_INFO_OFFSET4 + sizeof(struct fw_info)))
+    {
+        return B0_SCRUB_STATUS_IO_ERR;
+    }
+    const struct fw_info* const p_info = fw_info_find((uint32_t)g_scrub_buf); // NOSONAR: address of the buffer
+    if ((NULL == p_info) || (p_info->address < p_part->int_addr)
+        || (((p_info->address - p_part->int_addr) + p_info->size) > p_fa->fa_size))
+    {
+        return B0_SCRUB_STATUS_INVALID_IMG;
+    }
+    const uint32_t magic_common = p_info->magic[0];
+    const uint32_t fw_address   = p_info->address;
+    p_ref->start_offset         = p_info->address - p_part->int_addr;
+    p_ref->end_offset           = p_ref->start_offset + p_info->size;
+
+    /* NSIB looks for the validation info right after the firmware or one word later. */
+    for (uint32_t pad = 0; pad <= sizeof(uint32_t); pad += sizeof(uint32_t))
+    {
+        struct fw_validation_info val_info;
+
+        const uint32_t val_offset = p_ref->end_offset + pad;
+        if ((val_offset + sizeof(val_info)) > p_fa->fa_size)
+        {
+            break;
+        }
+        if (0 != flash_area_read(p_fa, (off_t)val_offset, &val_info, sizeof(val_info)))
+        {
+            return B0_SCRUB_STATUS_IO_ERR;
+        }
+        if ((magic_common == val_info.magic[0]) && (fw_address == val_info.address))
+        {
+            memcpy(p_ref->digest, val_info.hash, sizeof(p_ref->digest));
+            return B0_SCRUB_STATUS_OK;
+        }
+    }
+    return B0_SCRUB_STATUS_INVALID_IMG;
+}
+
+static b0_scrub_status_e
+b0_scrub_get_ref_mcuboot_tlv(const struct flash_area* const p_fa, b0_scrub_ref_t* const p_ref)
+{
+    b0_scrub_mcuboot_hdr_t hdr = { 0 };
+    if (0 != flash_area_read(p_fa, 0, &hdr, sizeof(hdr)))
+    {
+        return B0_SCRUB_STATUS_IO_ERR;
+    }
+    /* The image hash covers the header, the image and the protected TLV area. */
+    const uint32_t tlv_offset = (uint32_t)hdr.hdr_size + hdr.img_size + hdr.protect_tlv_size;
+    if ((B0_SCRUB_MCUBOOT_IMAGE_MAGIC != hdr.magic) || ((tlv_offset + sizeof(b0_scrub_mcuboot_tlv_t)) > p_fa->fa_size))
+    {
+        return B0_SCRUB_STATUS_INVALID_IMG;
+    }
+    p_ref->start_offset = 0;
+    p_ref->end_offset   = tlv_offset;
+
+    b0_scrub_mcuboot_tlv_t tlv = { 0 };
+    if (0 != flash_area_read(p_fa, (off_t)tlv_offset, &tlv, sizeof(tlv)))
+    {
+        return B0_SCRUB_STATUS_IO_ERR;
+    }
+    const uint32_t tlv_end = tlv_offset + tlv.len;
+    if ((B0_SCRUB_MCUBOOT_TLV_INFO_MAGIC != tlv.type) || (tlv_end > p_fa->fa_size))
+    {
+        return B0_SCRUB_STATUS_INVALID_IMG;
+    }
+    uint32_t offset = tlv_offset + sizeof(tlv);
+    while ((offset + sizeof(tlv)) <= tlv_end)
+    {
+        if (0 != flash_area_read(p_fa, (off_t)offset, &tlv, sizeof(tlv)))
+        {
+            return B0_SCRUB_STATUS_IO_ERR;
+        }
+        offset += sizeof(tlv);
+        if ((B0_SCRUB_MCUBOOT_TLV_SHA256 == tlv.type) && (sizeof(p_ref->digest) == tlv.len)
+            && ((offset + tlv.len) <= tlv_end))
+        {
+            return (0 == flash_area_read(p_fa, (off_t)offset, p_ref->digest, sizeof(p_ref->digest)))
+                       ? B0_SCRUB_STATUS_OK
+                       : B0_SCRUB_STATUS_IO_ERR;
+        }
+        offset += tlv.len;
+    }
+    return B0_SCRUB_STATUS_INVALID_IMG;
+}
+
+static b0_scrub_status_e
+b0_scrub_get_ref(const struct flash_area* const p_fa, const b0_scrub_part_t* const p_part, b0_scrub_ref_t* const p_ref)
+{
+    memset(p_ref, 0, sizeof(*p_ref));
+    switch (p_part->ref_type)
+    {
+        case B0_SCRUB_REF_TYPE_FW_VALIDATION:
+            return b0_scrub_get_ref_fw_validation(p_fa, p_part, p_ref);
+        case B0_SCRUB_REF_TYPE_MCUBOOT_TLV:
+            return b0_scrub_get_ref_mcuboot_tlv(p_fa, p_ref);
+        default:
+            p_ref->start_offset = 0;
+            p_ref->end_offset   = (uint32_t)p_fa->fa_size;
+            return B0_SCRUB_STATUS_OK;
+    }
+}
+
+static uint32_t
+b0_scrub_get_digest_prefix(const b0_scrub_ref_t* const p_ref)
+{
+    uint32_t prefix = 0;
+    memcpy(&prefix, p_ref->digest, sizeof(prefix));
+    return prefix;
+}
+
+/**
+ * @brief Check the next slice of the partition.
+ * @return B0_SCRUB_STATUS_NOT_CHECKED if the budget is exhausted before the end of the partition,
+ *         the result of the check otherwise.
+ */
+static b0_scrub_status_e
+b0_scrub_check_slice(
+    b0_scrub_state_t* const        p_state,
+    const struct flash_area* const p_fa,
+    const b0_scrub_part_t* const   p_part,
+    uint32_t* const                p_budget)
+{
+    bl_sha256_ctx_t* const p_ctx    = (bl_sha256_ctx_t*)p_state->hash_ctx; // NOSONAR: opaque retained storage
+    const bool             use_hash = B0_SCRUB_REF_TYPE_INT_COPY != p_part->ref_type;
+    b0_scrub_ref_t         ref      = { 0 };
+    b0_scrub_status_e      status   = B0_SCRUB_STATUS_OK;
+
+    if (0 == p_state->end_offset)
+    {
+        status = b0_scrub_get_ref(p_fa, p_part, &ref);
+        if (B0_SCRUB_STATUS_OK != status)
+        {
+            return status;
+        }
+        if (use_hash && (0 != bl_sha256_init(p_ctx)))
+        {
+            return B0_SCRUB_STATUS_IO_ERR;
+        }
+        p_state->offset            = ref.start_offset;
+        p_state->end_offset        = ref.end_offset;
+        p_state->ref_digest_prefix = b0_scrub_get_digest_prefix(&ref);
+    }
+
+    while ((p_state->offset < p_state->end_offset) && (0 != *p_budget))
+    {
+        const uint32_t len = MIN(MIN(B0_SCRUB_CHUNK_SIZE, p_state->end_offset - p_state->offset), *p_budget);
+        if (0 != flash_area_read(p_fa, (off_t)p_state->offset, g_scrub_buf, len))
+        {
+            return B0_SCRUB_STATUS_IO_ERR;
+        }
+        if (!use_hash)
+        {
+            const uint8_t* const p_int = (const uint8_t*)(p_part->int_addr + p_state->offset); // NOSONAR
+            if (0 != memcmp(g_scrub_buf, p_int, len))
+            {
+                LOG_ERR("B0: Scrub: %s differs at offset 0x%08x", p_part->p_fa_name, p_state->offset);
+                return B0_SCRUB_STATUS_MISMATCH;
+            }
+        }
+        else if (0 != bl_sha256_update(p_ctx, g_scrub_buf, len))
+        {
+            return B0_SCRUB_STATUS_IO_ERR;
+        }
+        p_state->offset += len;
+        *p_budget -= len;
+    }
+    if (p_state->offset < p_state->end_offset)
+    {
+        return B0_SCRUB_STATUS_NOT_CHECKED;
+    }
+    if (!use_hash)
+    {
+        return B0_SCRUB_STATUS_OK;
+    }
+
+    uint8_t digest[B0_SCRUB_DIGEST_SIZE];
+    if (0 != bl_sha256_finalize(p_ctx, digest))
+    {
+        return B0_SCRUB_STATUS_IO_ERR;
+    }
+    /* The reference is read again, since the image could have been replaced while it was being hashed. */
+    status = b0_scrub_get_ref(p_fa, p_part, &ref);
+    if (B0_SCRUB_STATUS_OK != status)
+    {
+        return status;
+    }
+    if ((p_state->ref_digest_prefix != b0_scrub_get_digest_prefix(&ref)) || (p_state->end_offset != ref.end_offset))
+    {
+        LOG_INF("B0: Scrub: %s has been replaced, start it again", p_part->p_fa_name);
+        p_state->end_offset = 0;
+        return B0_SCRUB_STATUS_NOT_CHECKED;
+    }
+    return (0 == memcmp(digest, ref.digest, sizeof(digest))) ? B0_SCRUB_STATUS_OK : B0_SCRUB_STATUS_MISMATCH;
+}
+
+static b0_scrub_status_e
+b0_scrub_check_part(b0_scrub_state_t* const p_state, const b0_scrub_part_t* const p_part, uint32_t* const p_budget)
+{
+    const struct flash_area* p_fa = NULL;
+    if (0 != flash_area_open(p_part->fa_id, &p_fa))
+    {
+        LOG_ERR("Failed to open flash area %d (%s)", p_part->fa_id, p_part->p_fa_name);
+        return B0_SCRUB_STATUS_IO_ERR;
+    }
+    const b0_scrub_status_e status = b0_scrub_check_slice(p_state, p_fa, p_part, p_budget);
+    flash_area_close(p_fa);
+    return status;
+}
+
+static void
+b0_scrub_save_state(b0_scrub_state_t* const p_state)
+{
+    p_state->crc32 = crc32_ieee((const uint8_t*)p_state, offsetof(b0_scrub_state_t, crc32));
+    memcpy(&b0_retained_get()->scrub, p_state, sizeof(*p_state));
+}
+
+void
+b0_scrub_run(void)
+{
+    b0_scrub_state_t* const p_retained = &b0_retained_get()->scrub;
+    b0_scrub_state_t* const p_state    = &g_scrub_state;
+
+    if (b0_scrub_is_state_valid(p_retained))
+    {
+        memcpy(p_state, p_retained, sizeof(*p_state));
+    }
+    else
+    {
+        LOG_INF("B0: Scrub: start from the beginning");
+        b0_scrub_reset_state(p_state);
+    }
+    if ((p_state->num_skipped_boots + 1U) < B0_SCRUB_BOOT_INTERVAL)
+    {
+        p_state->num_skipped_boots += 1;
+        b0_scrub_save_state(p_state);
+        return;
+    }
+    p_state->num_skipped_boots = 0;
+
+    const uint32_t timestamp = k_uptime_get_32();
+    /* With 'zephyr,deferred-init' the external flash is powered only for the scrub. */
+    const bool is_ext_flash_active = b0_ext_flash_is_active();
+    if ((!is_ext_flash_active) && (!b0_ext_flash_activate()))
+    {
+        LOG_ERR("B0: Scrub: failed to activate external flash");
+        b0_ext_flash_deactivate();
+        b0_scrub_save_state(p_state);
+        return;
+    }
+
+    uint32_t budget = B0_SCRUB_BYTES_PER_RUN;
+    /* Each partition is visited at most once per run, so that a broken image can't stall the boot. */
+    for (uint32_t i = 0; (i < B0_SCRUB_NUM_PARTITIONS) && (0 != budget); ++i)
+    {
+        const b0_scrub_part_t* const p_part = &g_scrub_parts[p_state->part_idx];
+        const b0_scrub_status_e      status = b0_scrub_check_part(p_state, p_part, &budget);
+        if (B0_SCRUB_STATUS_NOT_CHECKED == status)
+        {
+            break;
+        }
+        b0_scrub_part_res_t* const p_res = &p_state->parts[p_state->part_idx];
+
+        p_res->status   = (uint8_t)status;
+        p_res->pass_num = p_state->num_passes;
+        if (B0_SCRUB_STATUS_OK == status)
+        {
+            LOG_INF("B0: Scrub: %s: OK", p_part->p_fa_name);
+        }
+        else
+        {
+            p_state->num_failures += 1;
+            LOG_ERR("B0: Scrub: %s: failed, status=%u", p_part->p_fa_name, status);
+        }
+        p_state->offset            = 0;
+        p_state->end_offset        = 0;
+        p_state->ref_digest_prefix = 0;
+        p_state->part_idx += 1;
+        if (B0_SCRUB_NUM_PARTITIONS == p_state->part_idx)
+        {
+            p_state->part_idx = 0;
+            p_state->num_passes += 1;
+            LOG_INF("B0: Scrub: pass #%u finished, failures: %u", p_state->num_passes, p_state->num_failures);
+        }
+    }
+
+    if (!is_ext_flash_active)
+    {
+        b0_ext_flash_deactivate();
+    }
+    b0_scrub_save_state(p_state);
+    LOG_INF(
+        "B0: Scrub: %s at offset 0x%08x/0x%08x, %u ms",
+        g_scrub_parts[p_state->part_idx].p_fa_name,
+        p_state->offset,
+        p_state->end_offset,
+        k_uptime_get_32() - timestamp);
+}
@@ -0,0 +1,26 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#if !defined(B0_SCRUB_H)
+#define B0_SCRUB_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Check the next slice of the factory images in external flash against their stored digests.
+ * @note The cursor, the running hash and the results are kept in the retained RAM (see b0_retained.h),
+ *       so the whole set of factory images is covered over many boots.
+ *       The slice is checked on every B0_SCRUB_BOOT_INTERVAL-th call only. If the external flash is not
+ *       active, it is powered up for the check and powered off afterwards (see b0_ext_flash_deactivate).
+ */
+void
+b0_scrub_run(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // B0_SCRUB_H
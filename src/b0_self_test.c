@@ -0,0 +1,135 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "b0_self_test.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/crc.h>
+#include <flash_map_pm.h>
+#include "btldr_img_op.h"
+#include "b0_ext_flash_power.h"
+#include "b0_retained.h"
+#include "ruuvi_fa_id.h"
+
+LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
+
+typedef struct b0_self_test_part_t
+{
+    fa_id_t     fa_id_src;
+    const char* p_fa_src_name;
+    fa_id_t     fa_id_dst;
+    const char* p_fa_dst_name;
+    bool        has_fw_info;
+} b0_self_test_part_t;
+
+static const b0_self_test_part_t g_self_test_parts[B0_SELF_TEST_NUM_PARTITIONS] = {
+    { FIXED_PARTITION_ID(provision_ext), "provision_ext", FIXED_PARTITION_ID(provision), "provision", false },
+    { FIXED_PARTITION_ID(s0_ext), "s0_ext", FIXED_PARTITION_ID(s0), "s0", true },
+    { FIXED_PARTITION_ID(s1_ext), "s1_ext", FIXED_PARTITION_ID(s1), "s1", true },
+    { FIXED_PARTITION_ID(mcuboot_primary_ext),
+      "mcuboot_primary_ext",
+      FIXED_PARTITION_ID(mcuboot_primary),
+      "mcuboot_primary",
+      true },
+    { FIXED_PARTITION_ID(mcuboot_secondary_ext),
+      "mcuboot_secondary_ext",
+      FIXED_PARTITION_ID(mcuboot_secondary),
+      "mcuboot_secondary",
+      true },
+};
+
+static void
+b0_self_test_check_part(const b0_self_test_part_t* const p_part, b0_self_test_part_res_t* const p_res)
+{
+    p_res->fa_id_src = (uint8_t)p_part->fa_id_src;
+    p_res->fa_id_dst = (uint8_t)p_part->fa_id_dst;
+
+    if (p_part->has_fw_info && !btldr_img_op_check_fw_info(p_part->fa_id_src, p_part->p_fa_src_name))
+    {
+        p_res->status = B0_SELF_TEST_STATUS_INVALID_IMG;
+        return;
+    }
+
+    const struct flash_area* p_fa = NULL;
+    if (0 != flash_area_open(p_part->fa_id_src, &p_fa))
+    {
+        LOG_ERR("Failed to open flash area %d (%s)", p_part->fa_id_src, p_part->p_fa_src_name);
+        p_res->status = B0_SELF_TEST_STATUS_IO_ERR;
+        return;
+    }
+    p_res->size = (uint32_t)p_fa->fa_size;
+    flash_area_close(p_fa);
+
+    btldr_img_op_cmp_stat_t stat = {
+        .p_mismatch_offsets = p_res->mismatch_offsets,
+        .max_offsets        = B0_SELF_TEST_MAX_MISMATCHES_PER_PART,
+    };
+    const uint32_t timestamp = k_uptime_get_32();
+    const bool     is_ok     = btldr_img_op_cmp_all(p_part->fa_id_dst, p_part->fa_id_src, &stat);
+    p_res->duration_ms       = k_uptime_get_32() - timestamp;
+
+    p_res->num_mismatches = stat.num_mismatches;
+    p_res->num_offsets    = (uint8_t)stat.num_offsets;
+    p_res->bytes_per_sec  = (uint32_t)(((uint64_t)p_res->size * 1000U) / MAX(p_res->duration_ms, 1U));
+    if (!is_ok)
+    {
+        p_res->status = B0_SELF_TEST_STATUS_IO_ERR;
+    }
+    else if (0 != stat.num_mismatches)
+    {
+        p_res->status = B0_SELF_TEST_STATUS_MISMATCH;
+    }
+    else
+    {
+        p_res->status = B0_SELF_TEST_STATUS_OK;
+    }
+    LOG_INF(
+        "B0: Self-test: %s -> %s: status=%u, mismatches=%u, %u bytes in %u ms (%u B/s)",
+        p_part->p_fa_src_name,
+        p_part->p_fa_dst_name,
+        p_res->status,
+        p_res->num_mismatches,
+        p_res->size,
+        p_res->duration_ms,
+        p_res->bytes_per_sec);
+}
+
+void
+b0_self_test_run(void)
+{
+    b0_self_test_report_t* const p_report = &b0_retained_get()->self_test;
+
+    const uint32_t seq_num = (B0_SELF_TEST_REPORT_MAGIC == p_report->magic) ? (p_report->seq_num + 1) : 0;
+
+    memset(p_report, 0, sizeof(*p_report));
+    p_report->seq_num = seq_num;
+
+    LOG_INF("B0: Run recovery self-test #%u", seq_num);
+    const uint32_t timestamp = k_uptime_get_32();
+
+    if (b0_ext_flash_activate())
+    {
+        p_report->is_ext_imgs_valid = true;
+        for (uint32_t i = 0; i < B0_SELF_TEST_NUM_PARTITIONS; ++i)
+        {
+            b0_self_test_check_part(&g_self_test_parts[i], &p_report->parts[i]);
+            if (B0_SELF_TEST_STATUS_INVALID_IMG == p_report->parts[i].status)
+            {
+                p_report->is_ext_imgs_valid = false;
+            }
+        }
+    }
+
+    p_report->duration_ms = k_uptime_get_32() - timestamp;
+    p_report->magic       = B0_SELF_TEST_REPORT_MAGIC;
+    p_report->crc32       = crc32_ieee((const uint8_t*)p_report, offsetof(b0_self_test_report_t, crc32));
+    LOG_INF(
+        "B0: Recovery self-test finished in %u ms, ext images are %s",
+        p_report->duration_ms,
+        p_report->is_ext_imgs_valid ? "valid" : "invalid");
+}
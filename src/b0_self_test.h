@@ -0,0 +1,23 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#if !defined(B0_SELF_TEST_H)
+#define B0_SELF_TEST_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Run a dry-run of the factory fw recovery without writing to flash.
+ * @note The results are stored in the retained RAM (see b0_retained.h) for the application.
+ */
+void
+b0_self_test_run(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // B0_SELF_TEST_H
@@ -0,0 +1,108 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "b0_serial_proto.h"
+#include <string.h>
+#include <zephyr/sys/crc.h>
+
+void
+b0_serial_proto_parser_reset(b0_serial_proto_parser_t* const p_parser)
+{
+    p_parser->state = B0_SERIAL_PROTO_PARSER_STATE_SOF;
+    p_parser->idx   = 0;
+}
+
+static uint32_t
+b0_serial_proto_calc_crc(const uint8_t* const p_hdr, const uint8_t* const p_payload, const uint16_t len)
+{
+    uint32_t crc = crc32_ieee_update(0, p_hdr, B0_SERIAL_PROTO_HDR_SIZE - 1);
+    return crc32_ieee_update(crc, p_payload, len);
+}
+
+b0_serial_proto_parser_res_e
+b0_serial_proto_parser_feed(b0_serial_proto_parser_t* const p_parser, const uint8_t byte)
+{
+    b0_serial_proto_frame_t* const p_frame = &p_parser->frame;
+    switch (p_parser->state)
+    {
+        case B0_SERIAL_PROTO_PARSER_STATE_SOF:
+            if (B0_SERIAL_PROTO_SOF == byte)
+            {
+                p_parser->state = B0_SERIAL_PROTO_PARSER_STATE_HDR;
+                p_parser->idx   = 0;
+            }
+            break;
+
+        case B0_SERIAL_PROTO_PARSER_STATE_HDR:
+            p_parser->hdr[p_parser->idx++] = byte;
+            if (p_parser->idx < sizeof(p_parser->hdr))
+            {
+                break;
+            }
+            p_frame->type = p_parser->hdr[0];
+            p_frame->seq  = b0_serial_proto_get_u16(&p_parser->hdr[1]);
+            p_frame->len  = b0_serial_proto_get_u16(&p_parser->hdr[3]);
+            if (p_frame->len > B0_SERIAL_PROTO_MAX_PAYLOAD)
+            {
+                // Most likely a false SOF inside the data of a lost frame
+                p_parser->num_crc_errors += 1;
+                b0_serial_proto_parser_reset(p_parser);
+                return B0_SERIAL_PROTO_PARSER_RES_CRC_ERROR;
+            }
+            p_parser->idx   = 0;
+            p_parser->state = (0 != p_frame->len) ? B0_SERIAL_PROTO_PARSER_STATE_PAYLOAD
+                                                  : B0_SERIAL_PROTO_PARSER_STATE_CRC;
+            break;
+
+        case B0_SERIAL_PROTO_PARSER_STATE_PAYLOAD:
+            p_frame->payload[p_parser->idx++] = byte;
+            if (p_parser->idx == p_frame->len)
+            {
+                p_parser->idx   = 0;
+                p_parser->state = B0_SERIAL_PROTO_PARSER_STATE_CRC;
+            }
+            break;
+
+        case B0_SERIAL_PROTO_PARSER_STATE_CRC:
+            p_parser->crc[p_parser->idx++] = byte;
+            if (p_parser->idx < sizeof(p_parser->crc))
+            {
+                break;
+            }
+            b0_serial_proto_parser_reset(p_parser);
+            if (b0_serial_proto_get_u32(p_parser->crc)
+                != b0_serial_proto_calc_crc(p_parser->hdr, p_frame->payload, p_frame->len))
+            {
+                p_parser->num_crc_errors += 1;
+                return B0_SERIAL_PROTO_PARSER_RES_CRC_ERROR;
+            }
+            return B0_SERIAL_PROTO_PARSER_RES_FRAME;
+
+        default:
+            b0_serial_proto_parser_reset(p_parser);
+            break;
+    }
+    return B0_SERIAL_PROTO_PARSER_RES_IN_PROGRESS;
+}
+
+size_t
+b0_serial_proto_encode(
+    uint8_t* const       p_buf,
+    const uint8_t        type,
+    const uint16_t       seq,
+    const uint8_t* const p_payload,
+    const uint16_t       len)
+{
+    p_buf[0] = B0_SERIAL_PROTO_SOF;
+    p_buf[1] = type;
+    b0_serial_proto_put_u16(&p_buf[2], seq);
+    b0_serial_proto_put_u16(&p_buf[4], len);
+    if (0 != len)
+    {
+        memcpy(&p_buf[B0_SERIAL_PROTO_HDR_SIZE], p_payload, len);
+    }
+    const uint32_t crc = b0_serial_proto_calc_crc(&p_buf[1], &p_buf[B0_SERIAL_PROTO_HDR_SIZE], len);
+    b0_serial_proto_put_u32(&p_buf[B0_SERIAL_PROTO_HDR_SIZE + len], crc);
+    return B0_SERIAL_PROTO_HDR_SIZE + len + B0_SERIAL_PROTO_CRC_SIZE;
+}
@@ -0,0 +1,159 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#if !defined(B0_SERIAL_PROTO_H)
+#define B0_SERIAL_PROTO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Frame format (all multi-byte fields are little-endian):
+ *   SOF (0xB0) | type (1) | seq (2) | len (2) | payload (len) | crc32 (4)
+ * The CRC-32 (IEEE) covers the fields from 'type' up to the end of the payload.
+ *
+ * The host sends DATA frames with seq = chunk index, the offset in the slot is seq * B0_SERIAL_PROTO_CHUNK_SIZE.
+ * Up to 'window' DATA frames (announced in HELLO_RSP) may be sent without being acknowledged (go-back-N).
+ * The device replies ACK with seq = next expected chunk index (cumulative),
+ * or NAK with seq = next expected chunk index when a frame was lost or damaged.
+ * Other requests are acknowledged with the seq of the request.
+ */
+
+#define B0_SERIAL_PROTO_VERSION (1U)
+
+#define B0_SERIAL_PROTO_SOF (0xB0U)
+
+#define B0_SERIAL_PROTO_HDR_SIZE       (6U) // SOF, type, seq, len
+#define B0_SERIAL_PROTO_CRC_SIZE       (4U)
+#define B0_SERIAL_PROTO_CHUNK_SIZE     (512U)
+#define B0_SERIAL_PROTO_MAX_PAYLOAD    (B0_SERIAL_PROTO_CHUNK_SIZE)
+#define B0_SERIAL_PROTO_FRAME_MAX_SIZE \
+    (B0_SERIAL_PROTO_HDR_SIZE + B0_SERIAL_PROTO_MAX_PAYLOAD + B0_SERIAL_PROTO_CRC_SIZE)
+
+typedef enum b0_serial_proto_type_e
+{
+    B0_SERIAL_PROTO_TYPE_HELLO     = 0x01, //!< Payload: none; response HELLO_RSP
+    B0_SERIAL_PROTO_TYPE_SET_BAUD  = 0x02, //!< Payload: baudrate (4); switched after the ACK has been sent
+    B0_SERIAL_PROTO_TYPE_BEGIN     = 0x03, //!< Payload: slot (1), image size (4), image crc32 (4)
+    B0_SERIAL_PROTO_TYPE_DATA      = 0x04, //!< Payload: up to B0_SERIAL_PROTO_CHUNK_SIZE bytes of the image
+    B0_SERIAL_PROTO_TYPE_END       = 0x05, //!< Payload: none; the image is verified by reading it back from flash
+    B0_SERIAL_PROTO_TYPE_FINISH    = 0x06, //!< Payload: none; s0/s1 are validated against the provisioned keys
+    B0_SERIAL_PROTO_TYPE_ACK       = 0x81, //!< Payload: none
+    B0_SERIAL_PROTO_TYPE_NAK       = 0x82, //!< Payload: error code (1)
+    B0_SERIAL_PROTO_TYPE_HELLO_RSP = 0x83, //!< Payload: version (1), window (1), chunk size (2), max baudrate (4)
+} b0_serial_proto_type_e;
+
+typedef enum b0_serial_proto_err_e
+{
+    B0_SERIAL_PROTO_ERR_SEQ      = 0x01, //!< DATA frame is out of order or damaged, resend from seq
+    B0_SERIAL_PROTO_ERR_PARAM    = 0x02, //!< Invalid request parameters
+    B0_SERIAL_PROTO_ERR_STATE    = 0x03, //!< Request is not expected in the current state
+    B0_SERIAL_PROTO_ERR_FLASH    = 0x04, //!< Flash erase or write failed
+    B0_SERIAL_PROTO_ERR_VERIFY   = 0x05, //!< Image CRC, fw_info or signature check failed
+    B0_SERIAL_PROTO_ERR_BAUDRATE = 0x06, //!< Baudrate is not supported
+} b0_serial_proto_err_e;
+
+/* Slot 0 was the provision partition, it is rejected: the public keys of B0 can't be replaced over UART. */
+typedef enum b0_serial_proto_slot_e
+{
+    B0_SERIAL_PROTO_SLOT_S0                = 1,
+    B0_SERIAL_PROTO_SLOT_S1                = 2,
+    B0_SERIAL_PROTO_SLOT_MCUBOOT_PRIMARY   = 3,
+    B0_SERIAL_PROTO_SLOT_MCUBOOT_SECONDARY = 4,
+    B0_SERIAL_PROTO_NUM_SLOTS,
+} b0_serial_proto_slot_e;
+
+typedef struct b0_serial_proto_frame_t
+{
+    uint8_t  type;
+    uint16_t seq;
+    uint16_t len;
+    uint8_t  payload[B0_SERIAL_PROTO_MAX_PAYLOAD];
+} b0_serial_proto_frame_t;
+
+typedef enum b0_serial_proto_parser_state_e
+{
+    B0_SERIAL_PROTO_PARSER_STATE_SOF,
+    B0_SERIAL_PROTO_PARSER_STATE_HDR,
+    B0_SERIAL_PROTO_PARSER_STATE_PAYLOAD,
+    B0_SERIAL_PROTO_PARSER_STATE_CRC,
+} b0_serial_proto_parser_state_e;
+
+typedef struct b0_serial_proto_parser_t
+{
+    b0_serial_proto_parser_state_e state;
+    uint32_t                       idx;
+    uint8_t                        hdr[B0_SERIAL_PROTO_HDR_SIZE - 1];
+    uint8_t                        crc[B0_SERIAL_PROTO_CRC_SIZE];
+    uint32_t                       num_crc_errors;
+    b0_serial_proto_frame_t        frame;
+} b0_serial_proto_parser_t;
+
+typedef enum b0_serial_proto_parser_res_e
+{
+    B0_SERIAL_PROTO_PARSER_RES_IN_PROGRESS,
+    B0_SERIAL_PROTO_PARSER_RES_FRAME,     //!< A complete frame is available in p_parser->frame
+    B0_SERIAL_PROTO_PARSER_RES_CRC_ERROR, //!< A frame was dropped because of a CRC error or invalid length
+} b0_serial_proto_parser_res_e;
+
+void
+b0_serial_proto_parser_reset(b0_serial_proto_parser_t* const p_parser);
+
+/**
+ * @brief Feed one received byte to the frame parser.
+ */
+b0_serial_proto_parser_res_e
+b0_serial_proto_parser_feed(b0_serial_proto_parser_t* const p_parser, const uint8_t byte);
+
+/**
+ * @brief Encode a frame into the buffer.
+ * @param p_buf - buffer of at least B0_SERIAL_PROTO_HDR_SIZE + len + B0_SERIAL_PROTO_CRC_SIZE bytes.
+ * @return the frame length.
+ */
+size_t
+b0_serial_proto_encode(
+    uint8_t* const       p_buf,
+    const uint8_t        type,
+    const uint16_t       seq,
+    const uint8_t* const p_payload,
+    const uint16_t       len);
+
+static inline uint16_t
+b0_serial_proto_get_u16(const uint8_t* const p_buf)
+{
+    return (uint16_t)((uint16_t)p_buf[0] | ((uint16_t)p_buf[1] << 8U));
+}
+
+static inline uint32_t
+b0_serial_proto_get_u32(const uint8_t* const p_buf)
+{
+    return (uint32_t)p_buf[0] | ((uint32_t)p_buf[1] << 8U) | ((uint32_t)p_buf[2] << 16U) | ((uint32_t)p_buf[3] << 24U);
+}
+
+static inline void
+b0_serial_proto_put_u16(uint8_t* const p_buf, const uint16_t val)
+{
+    p_buf[0] = (uint8_t)(val & 0xFFU);
+    p_buf[1] = (uint8_t)(val >> 8U);
+}
+
+static inline void
+b0_serial_proto_put_u32(uint8_t* const p_buf, const uint32_t val)
+{
+    p_buf[0] = (uint8_t)(val & 0xFFU);
+    p_buf[1] = (uint8_t)((val >> 8U) & 0xFFU);
+    p_buf[2] = (uint8_t)((val >> 16U) & 0xFFU);
+    p_buf[3] = (uint8_t)(val >> 24U);
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // B0_SERIAL_PROTO_H
@@ -0,0 +1,718 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "b0_serial_recovery.h"
+
+#if B0_SERIAL_RECOVERY_ENABLED
+
+#include <stdint.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+#include <zephyr/drivers/uart.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/sys/crc.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <zephyr/sys/util.h>
+#include <flash_map_pm.h>
+#include <fw_info_bare.h>
+#include <bl_validation.h>
+#include "btldr_img_op.h"
+#include "b0_serial_proto.h"
+#include "b0_supercap.h"
+#include "ruuvi_fa_id.h"
+#include "zephyr_api.h"
+
+LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
+
+#define B0_SERIAL_RECOVERY_UART_NODE DT_CHOSEN(ruuvi_b0_serial_recovery)
+
+/* The highest baudrate supported by nRF52840 UARTE, it can be lowered for boards with a slower UART link */
+#if !defined(B0_SERIAL_RECOVERY_UARTE_MAX_BAUDRATE)
+#define B0_SERIAL_RECOVERY_UARTE_MAX_BAUDRATE (1000000U)
+#endif
+
+#define B0_SERIAL_RECOVERY_DEFAULT_BAUDRATE DT_PROP(B0_SERIAL_RECOVERY_UART_NODE, current_speed)
+
+#if defined(CONFIG_UART_USE_RUNTIME_CONFIGURE)
+#define B0_SERIAL_RECOVERY_MAX_BAUDRATE B0_SERIAL_RECOVERY_UARTE_MAX_BAUDRATE
+#else
+#define B0_SERIAL_RECOVERY_MAX_BAUDRATE B0_SERIAL_RECOVERY_DEFAULT_BAUDRATE
+#endif
+
+#define B0_SERIAL_RECOVERY_WAIT_HOST_MS       (60 * 1000)
+#define B0_SERIAL_RECOVERY_IDLE_TIMEOUT_MS    (30 * 1000)
+#define B0_SERIAL_RECOVERY_BAUD_FALLBACK_MS   (2 * 1000)
+#define B0_SERIAL_RECOVERY_TX_TIMEOUT_MS      (100)
+#define B0_SERIAL_RECOVERY_RX_DISABLE_WAIT_MS (100)
+
+#define B0_SERIAL_RECOVERY_RX_BUF_SIZE       (4096U)
+#define B0_SERIAL_RECOVERY_RX_TIMEOUT_US     (1000)
+#define B0_SERIAL_RECOVERY_RING_BUF_SIZE     (2U * B0_SERIAL_RECOVERY_RX_BUF_SIZE)
+#define B0_SERIAL_RECOVERY_PARSE_CHUNK_SIZE  (64U)
+#define B0_SERIAL_RECOVERY_FLASH_PAGE_SIZE   (4096U)
+#define B0_SERIAL_RECOVERY_FLASH_WRITE_ALIGN (4U)
+
+/* The CPU is stalled while the flash page is erased (in slices, see b0_flash_slice.h) and written,
+ * but UARTE continues receiving by DMA into the next RX buffer. The window is limited so that all frames
+ * which the host is allowed to send without acknowledgement fit into one RX buffer. */
+#define B0_SERIAL_RECOVERY_WINDOW (B0_SERIAL_RECOVERY_RX_BUF_SIZE / B0_SERIAL_PROTO_FRAME_MAX_SIZE)
+
+_Static_assert(B0_SERIAL_RECOVERY_WINDOW >= 2, "RX buffer is too small for pipelining");
+_Static_assert(B0_SERIAL_RECOVERY_WINDOW <= UINT8_MAX, "Window does not fit into HELLO_RSP");
+_Static_assert(
+    0 == (B0_SERIAL_RECOVERY_FLASH_PAGE_SIZE % B0_SERIAL_PROTO_CHUNK_SIZE),
+    "Chunks must not cross flash page boundaries");
+
+typedef struct b0_serial_recovery_slot_t
+{
+    fa_id_t     fa_id;
+    const char* p_fa_name;
+    uint32_t    b0_slot_addr; //!< Address of the slot which B0 validates and boots, 0 for the MCUboot slots
+    uint32_t    b0_slot_size;
+} b0_serial_recovery_slot_t;
+
+/* The provision partition is not writable over UART: the host is not authenticated, so B0 accepts only
+ * the images signed with the provisioned keys (MCUboot validates its own slots). */
+static const b0_serial_recovery_slot_t g_serial_recovery_slots[B0_SERIAL_PROTO_NUM_SLOTS] = {
+    [B0_SERIAL_PROTO_SLOT_S0]                = { FIXED_PARTITION_ID(s0), "s0", PM_S0_ADDRESS, PM_S0_SIZE },
+    [B0_SERIAL_PROTO_SLOT_S1]                = { FIXED_PARTITION_ID(s1), "s1", PM_S1_ADDRESS, PM_S1_SIZE },
+    [B0_SERIAL_PROTO_SLOT_MCUBOOT_PRIMARY]   = { FIXED_PARTITION_ID(mcuboot_primary), "mcuboot_primary", 0, 0 },
+    [B0_SERIAL_PROTO_SLOT_MCUBOOT_SECONDARY] = { FIXED_PARTITION_ID(mcuboot_secondary), "mcuboot_secondary", 0, 0 },
+};
+
+typedef struct b0_serial_recovery_session_t
+{
+    const struct flash_area* p_fa;
+    b0_serial_proto_slot_e   slot;
+    uint32_t                 img_size;
+    uint32_t                 img_crc;
+    uint16_t                 next_seq;
+    bool                     is_nak_sent;
+    uint32_t                 page_off;
+    uint32_t                 page_len;
+    uint32_t                 written_slots_mask;
+    bool                     is_connected;
+    bool                     is_finished;
+    uint32_t                 baudrate;
+    uint32_t                 last_frame_timestamp;
+} b0_serial_recovery_session_t;
+
+static const struct device* const g_serial_recovery_uart = DEVICE_DT_GET(B0_SERIAL_RECOVERY_UART_NODE);
+
+static uint8_t       g_rx_bufs[2][B0_SERIAL_RECOVERY_RX_BUF_SIZE];
+static uint8_t       g_rx_buf_next_idx;
+static volatile bool g_is_rx_overflow;
+static volatile bool g_is_rx_disabled;
+static volatile bool g_is_tx_done = true;
+static uint8_t       g_tx_buf[B0_SERIAL_PROTO_HDR_SIZE + 16U + B0_SERIAL_PROTO_CRC_SIZE];
+
+RING_BUF_DECLARE(g_rx_ring_buf, B0_SERIAL_RECOVERY_RING_BUF_SIZE);
+
+static uint8_t                      g_page_buf[B0_SERIAL_RECOVERY_FLASH_PAGE_SIZE] __aligned(4);
+static b0_serial_proto_parser_t     g_parser;
+static b0_serial_recovery_session_t g_session;
+
+static void
+b0_serial_recovery_uart_cb(const struct device* dev, struct uart_event* evt, void* user_data)
+{
+    (void)user_data;
+
+    switch (evt->type)
+    {
+        case UART_TX_DONE:
+        case UART_TX_ABORTED:
+            g_is_tx_done = true;
+            break;
+
+        case UART_RX_RDY:
+            if (ring_buf_put(&g_rx_ring_buf, &evt->data.rx.buf[evt->data.rx.offset], evt->data.rx.len)
+                != evt->data.rx.len)
+            {
+                g_is_rx_overflow = true;
+            }
+            break;
+
+        case UART_RX_BUF_REQUEST:
+            (void)uart_rx_buf_rsp(dev, g_rx_bufs[g_rx_buf_next_idx], sizeof(g_rx_bufs[0]));
+            g_rx_buf_next_idx ^= 1U;
+            break;
+
+        case UART_RX_DISABLED:
+            g_is_rx_disabled = true;
+            break;
+
+        default:
+            break;
+    }
+}
+
+static bool
+b0_serial_recovery_rx_start(void)
+{
+    g_is_rx_disabled  = false;
+    g_rx_buf_next_idx = 1U;
+    const zephyr_api_ret_t rc
+        = uart_rx_enable(g_serial_recovery_uart, g_rx_bufs[0], sizeof(g_rx_bufs[0]), B0_SERIAL_RECOVERY_RX_TIMEOUT_US);
+    if (0 != rc)
+    {
+        LOG_ERR("B0: uart_rx_enable failed, rc=%d", rc);
+        return false;
+    }
+    return true;
+}
+
+static void
+b0_serial_recovery_rx_stop(void)
+{
+    if (0 != uart_rx_disable(g_serial_recovery_uart))
+    {
+        return;
+    }
+    const uint32_t timestamp = k_uptime_get_32();
+    while ((!g_is_rx_disabled) && ((k_uptime_get_32() - timestamp) < B0_SERIAL_RECOVERY_RX_DISABLE_WAIT_MS))
+    {
+        k_busy_wait(100); // NOSONAR
+    }
+}
+
+static void
+b0_serial_recovery_wait_tx_done(void)
+{
+    const uint32_t timestamp = k_uptime_get_32();
+    while ((!g_is_tx_done) && ((k_uptime_get_32() - timestamp) < B0_SERIAL_RECOVERY_TX_TIMEOUT_MS))
+    {
+        k_busy_wait(10); // NOSONAR
+    }
+    if (!g_is_tx_done)
+    {
+        (void)uart_tx_abort(g_serial_recovery_uart);
+        g_is_tx_done = true;
+    }
+}
+
+static void
+b0_serial_recovery_send(const uint8_t type, const uint16_t seq, const uint8_t* const p_payload, const uint16_t len)
+{
+    b0_serial_recovery_wait_tx_done();
+    const size_t frame_len = b0_serial_proto_encode(g_tx_buf, type, seq, p_payload, len);
+    g_is_tx_done           = false;
+    if (0 != uart_tx(g_serial_recovery_uart, g_tx_buf, frame_len, SYS_FOREVER_US))
+    {
+        g_is_tx_done = true;
+    }
+}
+
+static void
+b0_serial_recovery_send_ack(const uint16_t seq)
+{
+    b0_serial_recovery_send(B0_SERIAL_PROTO_TYPE_ACK, seq, NULL, 0);
+}
+
+static void
+b0_serial_recovery_send_nak(const uint16_t seq, const b0_serial_proto_err_e err)
+{
+    const uint8_t payload = (uint8_t)err;
+    b0_serial_recovery_send(B0_SERIAL_PROTO_TYPE_NAK, seq, &payload, sizeof(payload));
+}
+
+static bool
+b0_serial_recovery_set_baudrate(const uint32_t baudrate)
+{
+#if defined(CONFIG_UART_USE_RUNTIME_CONFIGURE)
+    struct uart_config cfg = { 0 };
+    if (0 != uart_config_get(g_serial_recovery_uart, &cfg))
+    {
+        return false;
+    }
+    cfg.baudrate = baudrate;
+
+    b0_serial_recovery_wait_tx_done();
+    b0_serial_recovery_rx_stop();
+    const zephyr_api_ret_t rc = uart_configure(g_serial_recovery_uart, &cfg);
+    if (0 != rc)
+    {
+        LOG_ERR("B0: Failed to set baudrate %u, rc=%d", baudrate, rc);
+    }
+    ring_buf_reset(&g_rx_ring_buf);
+    b0_serial_proto_parser_reset(&g_parser);
+    if (!b0_serial_recovery_rx_start())
+    {
+        return false;
+    }
+    if (0 == rc)
+    {
+        g_session.baudrate = baudrate;
+    }
+    return 0 == rc;
+#else
+    return baudrate == B0_SERIAL_RECOVERY_DEFAULT_BAUDRATE;
+#endif
+}
+
+static bool
+b0_serial_recovery_is_page_erased(const uint32_t page_off)
+{
+    const uint32_t* const p_page = (const uint32_t*)(CONFIG_FLASH_BASE_ADDRESS + g_session.p_fa->fa_off + page_off);
+    for (uint32_t i = 0; i < (B0_SERIAL_RECOVERY_FLASH_PAGE_SIZE / sizeof(uint32_t)); ++i)
+    {
+        if (UINT32_MAX != p_page[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool
+b0_serial_recovery_flush_page(void)
+{
+    if (0 == g_session.page_len)
+    {
+        return true;
+    }
+    const uint32_t write_len = ROUND_UP(g_session.page_len, B0_SERIAL_RECOVERY_FLASH_WRITE_ALIGN);
+    memset(&g_page_buf[g_session.page_len], 0xFF, write_len - g_session.page_len);
+
+    zephyr_api_ret_t rc = 0;
+    if (!b0_serial_recovery_is_page_erased(g_session.page_off))
+    {
+        rc = btldr_img_op_erase_page(g_session.p_fa, g_session.page_off, B0_SERIAL_RECOVERY_FLASH_PAGE_SIZE);
+    }
+    if (0 == rc)
+    {
+        rc = flash_area_write(g_session.p_fa, g_session.page_off, g_page_buf, write_len);
+    }
+    if (0 == rc)
+    {
+        btldr_img_op_on_slice(BTLDR_IMG_OP_STAGE_WRITE, g_session.p_fa, (off_t)(g_session.page_off + write_len));
+    }
+    b0_supercap_on_page_boundary();
+    if (0 != rc)
+    {
+        LOG_ERR(
+            "B0: Failed to write %s at offset 0x%08x, rc=%d",
+            g_serial_recovery_slots[g_session.slot].p_fa_name,
+            g_session.page_off,
+            rc);
+        return false;
+    }
+    g_session.page_off += B0_SERIAL_RECOVERY_FLASH_PAGE_SIZE;
+    g_session.page_len = 0;
+    return true;
+}
+
+/**
+ * @brief Erase the rest of the slot so that no stale data (e.g. MCUboot trailer) remains after the image.
+ */
+static bool
+b0_serial_recovery_erase_tail(void)
+{
+    for (uint32_t page_off = g_session.page_off; page_off < g_session.p_fa->fa_size;
+         page_off += B0_SERIAL_RECOVERY_FLASH_PAGE_SIZE)
+    {
+        if (b0_serial_recovery_is_page_erased(page_off))
+        {
+            continue;
+        }
+        const zephyr_api_ret_t rc
+            = btldr_img_op_erase_page(g_session.p_fa, page_off, B0_SERIAL_RECOVERY_FLASH_PAGE_SIZE);
+        b0_supercap_on_page_boundary();
+        if (0 != rc)
+        {
+            LOG_ERR(
+                "B0: Failed to erase %s at offset 0x%08x, rc=%d",
+                g_serial_recovery_slots[g_session.slot].p_fa_name,
+                page_off,
+                rc);
+            return false;
+        }
+    }
+    return true;
+}
+
+static void
+b0_serial_recovery_close_slot(void)
+{
+    if (NULL != g_session.p_fa)
+    {
+        flash_area_close(g_session.p_fa);
+        g_session.p_fa = NULL;
+    }
+}
+
+static void
+b0_serial_recovery_handle_hello(const b0_serial_proto_frame_t* const p_frame)
+{
+    uint8_t payload[8];
+    payload[0] = B0_SERIAL_PROTO_VERSION;
+    payload[1] = (uint8_t)B0_SERIAL_RECOVERY_WINDOW;
+    b0_serial_proto_put_u16(&payload[2], B0_SERIAL_PROTO_CHUNK_SIZE);
+    b0_serial_proto_put_u32(&payload[4], B0_SERIAL_RECOVERY_MAX_BAUDRATE);
+    if (!g_session.is_connected)
+    {
+        LOG_INF("B0: Serial recovery: host connected");
+        g_session.is_connected = true;
+    }
+    b0_serial_recovery_send(B0_SERIAL_PROTO_TYPE_HELLO_RSP, p_frame->seq, payload, sizeof(payload));
+}
+
+static void
+b0_serial_recovery_handle_set_baud(const b0_serial_proto_frame_t* const p_frame)
+{
+    if (sizeof(uint32_t) != p_frame->len)
+    {
+        b0_serial_recovery_send_nak(p_frame->seq, B0_SERIAL_PROTO_ERR_PARAM);
+        return;
+    }
+    const uint32_t baudrate = b0_serial_proto_get_u32(p_frame->payload);
+    if ((baudrate > B0_SERIAL_RECOVERY_MAX_BAUDRATE) || (baudrate < B0_SERIAL_RECOVERY_DEFAULT_BAUDRATE))
+    {
+        b0_serial_recovery_send_nak(p_frame->seq, B0_SERIAL_PROTO_ERR_BAUDRATE);
+        return;
+    }
+    b0_serial_recovery_send_ack(p_frame->seq);
+    if (baudrate == g_session.baudrate)
+    {
+        return;
+    }
+    LOG_INF("B0: Serial recovery: switch to %u baud", baudrate);
+    (void)b0_serial_recovery_set_baudrate(baudrate);
+}
+
+static void
+b0_serial_recovery_handle_begin(const b0_serial_proto_frame_t* const p_frame)
+{
+    b0_serial_recovery_close_slot();
+    if ((9U != p_frame->len) || (p_frame->payload[0] < B0_SERIAL_PROTO_SLOT_S0)
+        || (p_frame->payload[0] >= B0_SERIAL_PROTO_NUM_SLOTS))
+    {
+        b0_serial_recovery_send_nak(p_frame->seq, B0_SERIAL_PROTO_ERR_PARAM);
+        return;
+    }
+    const b0_serial_proto_slot_e           slot   = (b0_serial_proto_slot_e)p_frame->payload[0];
+    const b0_serial_recovery_slot_t* const p_slot = &g_serial_recovery_slots[slot];
+
+    const struct flash_area* p_fa = NULL;
+    if (0 != flash_area_open(p_slot->fa_id, &p_fa))
+    {
+        b0_serial_recovery_send_nak(p_frame->seq, B0_SERIAL_PROTO_ERR_FLASH);
+        return;
+    }
+    const uint32_t img_size = b0_serial_proto_get_u32(&p_frame->payload[1]);
+    if ((0 == img_size) || (img_size > p_fa->fa_size)
+        || ((DIV_ROUND_UP(img_size, B0_SERIAL_PROTO_CHUNK_SIZE) - 1U) > UINT16_MAX))
+    {
+        LOG_ERR("B0: Serial recovery: image size %u does not fit into %s", img_size, p_slot->p_fa_name);
+        flash_area_close(p_fa);
+        b0_serial_recovery_send_nak(p_frame->seq, B0_SERIAL_PROTO_ERR_PARAM);
+        return;
+    }
+    LOG_INF("B0: Serial recovery: receive %s, size %u bytes", p_slot->p_fa_name, img_size);
+    g_session.p_fa        = p_fa;
+    g_session.slot        = slot;
+    g_session.img_size    = img_size;
+    g_session.img_crc     = b0_serial_proto_get_u32(&p_frame->payload[5]);
+    g_session.next_seq    = 0;
+    g_session.is_nak_sent = false;
+    g_session.page_off    = 0;
+    g_session.page_len    = 0;
+    g_session.written_slots_mask &= ~BIT(slot);
+    b0_serial_recovery_send_ack(p_frame->seq);
+}
+
+static void
+b0_serial_recovery_handle_data(const b0_serial_proto_frame_t* const p_frame)
+{
+    if (NULL == g_session.p_fa)
+    {
+        b0_serial_recovery_send_nak(p_frame->seq, B0_SERIAL_PROTO_ERR_STATE);
+        return;
+    }
+    if (p_frame->seq != g_session.next_seq)
+    {
+        if (p_frame->seq < g_session.next_seq)
+        {
+            // Retransmitted frame which has already been received (e.g. the ACK was lost)
+            b0_serial_recovery_send_ack(g_session.next_seq);
+        }
+        else if (!g_session.is_nak_sent)
+        {
+            // Request retransmission only once, the following frames of the window are out of order as well
+            g_session.is_nak_sent = true;
+            b0_serial_recovery_send_nak(g_session.next_seq, B0_SERIAL_PROTO_ERR_SEQ);
+        }
+        return;
+    }
+    const uint32_t offset = (uint32_t)p_frame->seq * B0_SERIAL_PROTO_CHUNK_SIZE;
+    if (((offset + p_frame->len) > g_session.img_size)
+        || ((B0_SERIAL_PROTO_CHUNK_SIZE != p_frame->len) && ((offset + p_frame->len) != g_session.img_size)))
+    {
+        b0_serial_recovery_send_nak(p_frame->seq, B0_SERIAL_PROTO_ERR_PARAM);
+        return;
+    }
+    memcpy(&g_page_buf[g_session.page_len], p_frame->payload, p_frame->len);
+    g_session.page_len += p_frame->len;
+    g_session.next_seq += 1;
+    g_session.is_nak_sent = false;
+
+    // Acknowledge before programming, so that the host sends the next window while the page is being written
+    b0_serial_recovery_send_ack(g_session.next_seq);
+
+    if ((B0_SERIAL_RECOVERY_FLASH_PAGE_SIZE == g_session.page_len) && !b0_serial_recovery_flush_page())
+    {
+        b0_serial_recovery_close_slot();
+        b0_serial_recovery_send_nak(g_session.next_seq, B0_SERIAL_PROTO_ERR_FLASH);
+    }
+}
+
+static void
+b0_serial_recovery_handle_end(const b0_serial_proto_frame_t* const p_frame)
+{
+    if ((NULL == g_session.p_fa)
+        || (((uint32_t)g_session.next_seq * B0_SERIAL_PROTO_CHUNK_SIZE) < g_session.img_size))
+    {
+        b0_serial_recovery_send_nak(p_frame->seq, B0_SERIAL_PROTO_ERR_STATE);
+        return;
+    }
+    const b0_serial_recovery_slot_t* const p_slot = &g_serial_recovery_slots[g_session.slot];
+    if ((!b0_serial_recovery_flush_page()) || (!b0_serial_recovery_erase_tail()))
+    {
+        b0_serial_recovery_close_slot();
+        b0_serial_recovery_send_nak(p_frame->seq, B0_SERIAL_PROTO_ERR_FLASH);
+        return;
+    }
+    const uint8_t* const p_img = (const uint8_t*)(CONFIG_FLASH_BASE_ADDRESS + g_session.p_fa->fa_off);
+    const uint32_t       crc   = crc32_ieee(p_img, g_session.img_size);
+    b0_serial_recovery_close_slot();
+    if (crc != g_session.img_crc)
+    {
+        LOG_ERR(
+            "B0: Serial recovery: CRC mismatch for %s: 0x%08x != 0x%08x",
+            p_slot->p_fa_name,
+            crc,
+            g_session.img_crc);
+        b0_serial_recovery_send_nak(p_frame->seq, B0_SERIAL_PROTO_ERR_VERIFY);
+        return;
+    }
+    LOG_INF("B0: Serial recovery: %s written successfully", p_slot->p_fa_name);
+    g_session.written_slots_mask |= BIT(g_session.slot);
+    b0_serial_recovery_send_ack(p_frame->seq);
+}
+
+/**
+ * @brief Check the image in the slot: s0/s1 must pass the validation by B0 against the provisioned keys,
+ *        the MCUboot slots must contain fw_info.
+ * @note As NSIB does before booting, fw_info is looked up at the allowed offsets (e.g. after the MCUboot header
+ *       in s0_pad), and the image is validated at the address it is linked for, which must be inside the slot.
+ */
+static bool
+b0_serial_recovery_is_slot_valid(const b0_serial_proto_slot_e slot)
+{
+    const b0_serial_recovery_slot_t* const p_slot = &g_serial_recovery_slots[slot];
+    if (0 == p_slot->b0_slot_addr)
+    {
+        return btldr_img_op_check_fw_info(p_slot->fa_id, p_slot->p_fa_name);
+    }
+    const struct fw_info* const p_info = fw_info_find(p_slot->b0_slot_addr);
+    if (NULL == p_info)
+    {
+        LOG_ERR("B0: Serial recovery: fw_info not found in %s", p_slot->p_fa_name);
+        return false;
+    }
+    if ((p_info->address < p_slot->b0_slot_addr) || (p_info->address >= (p_slot->b0_slot_addr + p_slot->b0_slot_size)))
+    {
+        LOG_ERR(
+            "B0: Serial recovery: image in %s is linked for address 0x%08x",
+            p_slot->p_fa_name,
+            (unsigned)p_info->address);
+        return false;
+    }
+    if (!bl_validate_firmware(p_info->address, p_info->address))
+    {
+        LOG_ERR("B0: Serial recovery: image in %s failed validation", p_slot->p_fa_name);
+        return false;
+    }
+    return true;
+}
+
+static bool
+b0_serial_recovery_check_images(void)
+{
+    for (uint32_t slot = B0_SERIAL_PROTO_SLOT_S0; slot < B0_SERIAL_PROTO_NUM_SLOTS; ++slot)
+    {
+        if ((0 != (g_session.written_slots_mask & BIT(slot)))
+            && !b0_serial_recovery_is_slot_valid((b0_serial_proto_slot_e)slot))
+        {
+            return false;
+        }
+    }
+    // At least one of the slots of the next stage bootloader must be bootable
+    return b0_serial_recovery_is_slot_valid(B0_SERIAL_PROTO_SLOT_S0)
+           || b0_serial_recovery_is_slot_valid(B0_SERIAL_PROTO_SLOT_S1);
+}
+
+static void
+b0_serial_recovery_handle_finish(const b0_serial_proto_frame_t* const p_frame)
+{
+    b0_serial_recovery_close_slot();
+    if ((0 == g_session.written_slots_mask) || !b0_serial_recovery_check_images())
+    {
+        b0_serial_recovery_send_nak(p_frame->seq, B0_SERIAL_PROTO_ERR_VERIFY);
+        return;
+    }
+    b0_serial_recovery_send_ack(p_frame->seq);
+    b0_serial_recovery_wait_tx_done();
+    g_session.is_finished = true;
+}
+
+static void
+b0_serial_recovery_handle_frame(const b0_serial_proto_frame_t* const p_frame)
+{
+    switch (p_frame->type)
+    {
+        case B0_SERIAL_PROTO_TYPE_HELLO:
+            b0_serial_recovery_handle_hello(p_frame);
+            break;
+        case B0_SERIAL_PROTO_TYPE_SET_BAUD:
+            b0_serial_recovery_handle_set_baud(p_frame);
+            break;
+        case B0_SERIAL_PROTO_TYPE_BEGIN:
+            b0_serial_recovery_handle_begin(p_frame);
+            break;
+        case B0_SERIAL_PROTO_TYPE_DATA:
+            b0_serial_recovery_handle_data(p_frame);
+            break;
+        case B0_SERIAL_PROTO_TYPE_END:
+            b0_serial_recovery_handle_end(p_frame);
+            break;
+        case B0_SERIAL_PROTO_TYPE_FINISH:
+            b0_serial_recovery_handle_finish(p_frame);
+            break;
+        default:
+            b0_serial_recovery_send_nak(p_frame->seq, B0_SERIAL_PROTO_ERR_PARAM);
+            break;
+    }
+}
+
+/**
+ * @brief Request retransmission of DATA frames after a damaged frame or lost bytes.
+ */
+static void
+b0_serial_recovery_on_rx_error(void)
+{
+    if ((NULL != g_session.p_fa) && !g_session.is_nak_sent)
+    {
+        g_session.is_nak_sent = true;
+        b0_serial_recovery_send_nak(g_session.next_seq, B0_SERIAL_PROTO_ERR_SEQ);
+    }
+}
+
+static void
+b0_serial_recovery_process_rx(void)
+{
+    uint8_t buf[B0_SERIAL_RECOVERY_PARSE_CHUNK_SIZE];
+    for (;;)
+    {
+        const unsigned int key = irq_lock();
+        const uint32_t     len = ring_buf_get(&g_rx_ring_buf, buf, sizeof(buf));
+        irq_unlock(key);
+        if (0 == len)
+        {
+            break;
+        }
+        for (uint32_t i = 0; (i < len) && !g_session.is_finished; ++i)
+        {
+            switch (b0_serial_proto_parser_feed(&g_parser, buf[i]))
+            {
+                case B0_SERIAL_PROTO_PARSER_RES_FRAME:
+                    g_session.last_frame_timestamp = k_uptime_get_32();
+                    b0_serial_recovery_handle_frame(&g_parser.frame);
+                    break;
+                case B0_SERIAL_PROTO_PARSER_RES_CRC_ERROR:
+                    b0_serial_recovery_on_rx_error();
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+}
+
+bool
+b0_serial_recovery_run(void)
+{
+    if (!device_is_ready(g_serial_recovery_uart))
+    {
+        LOG_ERR("B0: Serial recovery: UART %s is not ready", g_serial_recovery_uart->name);
+        return false;
+    }
+    memset(&g_session, 0, sizeof(g_session));
+    g_session.baudrate = B0_SERIAL_RECOVERY_DEFAULT_BAUDRATE;
+    b0_serial_proto_parser_reset(&g_parser);
+    ring_buf_reset(&g_rx_ring_buf);
+    g_is_rx_overflow = false;
+
+    if (0 != uart_callback_set(g_serial_recovery_uart, &b0_serial_recovery_uart_cb, NULL))
+    {
+        LOG_ERR("B0: Serial recovery: uart_callback_set failed");
+        return false;
+    }
+    if (!b0_serial_recovery_rx_start())
+    {
+        return false;
+    }
+    LOG_INF(
+        "B0: Serial recovery: wait for host on %s, %u baud (up to %u baud)",
+        g_serial_recovery_uart->name,
+        B0_SERIAL_RECOVERY_DEFAULT_BAUDRATE,
+        B0_SERIAL_RECOVERY_MAX_BAUDRATE);
+
+    b0_supercap_lock_power_off();
+    const uint32_t start_timestamp = k_uptime_get_32();
+    g_session.last_frame_timestamp = start_timestamp;
+    while (!g_session.is_finished)
+    {
+        if (g_is_rx_overflow)
+        {
+            LOG_ERR("B0: Serial recovery: RX overflow");
+            g_is_rx_overflow = false;
+            b0_serial_proto_parser_reset(&g_parser);
+            b0_serial_recovery_on_rx_error();
+        }
+        b0_serial_recovery_process_rx();
+
+        const uint32_t now = k_uptime_get_32();
+        if (!g_session.is_connected)
+        {
+            if ((now - start_timestamp) >= B0_SERIAL_RECOVERY_WAIT_HOST_MS)
+            {
+                LOG_ERR("B0: Serial recovery: host has not connected");
+                break;
+            }
+            continue;
+        }
+        const uint32_t idle_ms = now - g_session.last_frame_timestamp;
+        if ((B0_SERIAL_RECOVERY_DEFAULT_BAUDRATE != g_session.baudrate)
+            && (idle_ms >= B0_SERIAL_RECOVERY_BAUD_FALLBACK_MS))
+        {
+            // The host could not switch to the new baudrate, return to the default one
+            LOG_WRN("B0: Serial recovery: no frames at %u baud, fall back to default", g_session.baudrate);
+            (void)b0_serial_recovery_set_baudrate(B0_SERIAL_RECOVERY_DEFAULT_BAUDRATE);
+            g_session.last_frame_timestamp = now;
+        }
+        if (idle_ms >= B0_SERIAL_RECOVERY_IDLE_TIMEOUT_MS)
+        {
+            LOG_ERR("B0: Serial recovery: connection lost");
+            break;
+        }
+    }
+    b0_serial_recovery_close_slot();
+    b0_serial_recovery_rx_stop();
+    b0_supercap_unlock_power_off();
+    return g_session.is_finished;
+}
+
+#endif // B0_SERIAL_RECOVERY_ENABLED
@@ -0,0 +1,47 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#if !defined(B0_SERIAL_RECOVERY_H)
+#define B0_SERIAL_RECOVERY_H
+
+#include <stdbool.h>
+#include <zephyr/devicetree.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Serial recovery is enabled by pointing the 'ruuvi,b0-serial-recovery' chosen node to a UART
+ * and enabling CONFIG_UART_ASYNC_API (and CONFIG_UART_USE_RUNTIME_CONFIGURE to allow switching the baudrate). */
+#if DT_HAS_CHOSEN(ruuvi_b0_serial_recovery) && defined(CONFIG_UART_ASYNC_API)
+#define B0_SERIAL_RECOVERY_ENABLED 1
+#else
+#define B0_SERIAL_RECOVERY_ENABLED 0
+#endif
+
+#if B0_SERIAL_RECOVERY_ENABLED
+
+/**
+ * @brief Receive images over UART and program them into the internal slots (see b0_serial_proto.h).
+ * @return true if the host has finished the session and the written images are valid,
+ *         false if the host has not connected in time, the link was lost or the images are invalid.
+ */
+bool
+b0_serial_recovery_run(void);
+
+#else
+
+static inline bool
+b0_serial_recovery_run(void)
+{
+    return false;
+}
+
+#endif // B0_SERIAL_RECOVERY_ENABLED
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // B0_SERIAL_RECOVERY_H
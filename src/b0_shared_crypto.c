@@ -0,0 +1,133 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "b0_shared_crypto.h"
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/linker/devicetree_regions.h>
+#include <zephyr/toolchain.h>
+#include <fw_info.h>
+#include <bl_crypto.h>
+#include <bl_storage.h>
+#include "b0_retained.h"
+
+#define CONFIG_B0_SHARED_CRYPTO_EXT_API_ID    0x5230
+#define CONFIG_B0_SHARED_CRYPTO_EXT_API_FLAGS 0
+#define CONFIG_B0_SHARED_CRYPTO_EXT_API_VER   B0_SHARED_CRYPTO_EXT_API_VERSION
+
+_Static_assert(CONFIG_SB_HASH_LEN == B0_SHARED_CRYPTO_DIGEST_SIZE, "Unsupported hash length");
+
+typedef struct b0_shared_crypto_window_t
+{
+    bl_sha256_ctx_t ctx;
+    uint8_t         chunk_buf[B0_SHARED_CRYPTO_CHUNK_SIZE];
+} b0_shared_crypto_window_t;
+
+/* MCUboot can call crypto functions shared by B0 and this reserved memory area
+ * is used to pass content of MCUboot firmware image chunk by chunk for checking B0 signature. */
+static __aligned(4) __attribute__((used)) b0_shared_crypto_window_t
+    g_reserved_mem Z_GENERIC_SECTION(LINKER_DT_NODE_REGION_NAME(B0_SHARED_SRAM_NODE));
+_Static_assert(
+    (sizeof(g_reserved_mem) + B0_RETAINED_SIZE) <= DT_REG_SIZE(B0_SHARED_SRAM_NODE),
+    "shared_sram is too small for g_reserved_mem and b0_retained_t");
+
+static uint8_t*
+b0_shared_crypto_get_chunk_buf(void)
+{
+    return g_reserved_mem.chunk_buf;
+}
+
+static int
+b0_shared_crypto_hash_init(void)
+{
+    return bl_sha256_init(&g_reserved_mem.ctx);
+}
+
+static int
+b0_shared_crypto_hash_update(const uint32_t len)
+{
+    if (len > sizeof(g_reserved_mem.chunk_buf))
+    {
+        return -EINVAL;
+    }
+    return bl_sha256_update(&g_reserved_mem.ctx, g_reserved_mem.chunk_buf, len);
+}
+
+static int
+b0_shared_crypto_hash_finalize(uint8_t* const p_digest)
+{
+    return bl_sha256_finalize(&g_reserved_mem.ctx, p_digest);
+}
+
+static int
+b0_shared_crypto_calc_digest(const uint8_t* const p_data, const uint32_t len, uint8_t* const p_digest)
+{
+    int rc = bl_sha256_init(&g_reserved_mem.ctx);
+    if (0 == rc)
+    {
+        rc = bl_sha256_update(&g_reserved_mem.ctx, p_data, len);
+    }
+    if (0 == rc)
+    {
+        rc = bl_sha256_finalize(&g_reserved_mem.ctx, p_digest);
+    }
+    return rc;
+}
+
+static bool
+b0_shared_crypto_is_public_key_provisioned(const uint8_t* const p_public_key)
+{
+    uint8_t key_hash[B0_SHARED_CRYPTO_DIGEST_SIZE];
+    uint8_t provisioned_key_hash[CONFIG_SB_PUBLIC_KEY_HASH_LEN];
+
+    if (0 != b0_shared_crypto_calc_digest(p_public_key, CONFIG_SB_SIGNATURE_PUBLIC_KEY_LEN, key_hash))
+    {
+        return false;
+    }
+    const uint32_t num_public_keys = num_public_keys_read();
+    for (uint32_t i = 0; i < num_public_keys; ++i)
+    {
+        if (public_key_data_read(i, provisioned_key_hash) < 0)
+        {
+            continue; // Invalidated key
+        }
+        if (0 == memcmp(key_hash, provisioned_key_hash, CONFIG_SB_PUBLIC_KEY_HASH_LEN))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int
+b0_shared_crypto_verify(const uint8_t* const p_digest, const struct fw_validation_info* const p_val_info)
+{
+    if (0 != memcmp(p_digest, p_val_info->hash, B0_SHARED_CRYPTO_DIGEST_SIZE))
+    {
+        return -EBADMSG;
+    }
+    if (!b0_shared_crypto_is_public_key_provisioned(p_val_info->public_key))
+    {
+        return -EPERM;
+    }
+    /* The signature is calculated over the SHA-256 digest of the firmware digest. */
+    uint8_t digest2[B0_SHARED_CRYPTO_DIGEST_SIZE];
+    const int rc = b0_shared_crypto_calc_digest(p_digest, B0_SHARED_CRYPTO_DIGEST_SIZE, digest2);
+    if (0 != rc)
+    {
+        return rc;
+    }
+    return bl_secp256r1_validate(digest2, sizeof(digest2), p_val_info->public_key, p_val_info->signature);
+}
+
+EXT_API(B0_SHARED_CRYPTO, struct b0_shared_crypto_ext_api, b0_shared_crypto_ext_api) = {
+        .get_chunk_buf = &b0_shared_crypto_get_chunk_buf,
+        .hash_init     = &b0_shared_crypto_hash_init,
+        .hash_update   = &b0_shared_crypto_hash_update,
+        .hash_finalize = &b0_shared_crypto_hash_finalize,
+        .verify        = &b0_shared_crypto_verify,
+    }
+};
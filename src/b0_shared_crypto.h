@@ -0,0 +1,58 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#if !defined(B0_SHARED_CRYPTO_H)
+#define B0_SHARED_CRYPTO_H
+
+#include <stdint.h>
+#include <fw_info.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The version of the external API is incremented on every incompatible change of the functions
+ * or of the layout of shared_sram. MCUboot must check it before using the API.
+ * Version 1: shared_sram started with a buffer of MAX(PM_S0_SIZE, PM_S1_SIZE) bytes
+ *            into which MCUboot copied the whole image before calling the validation of B0.
+ * Version 2: shared_sram layout:
+ *            - offset 0: the hashing state (private to B0),
+ *            - followed by the chunk window of B0_SHARED_CRYPTO_CHUNK_SIZE bytes (see get_chunk_buf()),
+ *            - the last B0_RETAINED_SIZE bytes: b0_retained_t (see b0_retained.h).
+ *            The rest of the region is not used by B0. */
+#define B0_SHARED_CRYPTO_EXT_API_VERSION (2U)
+
+#define B0_SHARED_CRYPTO_CHUNK_SIZE  (4096U)
+#define B0_SHARED_CRYPTO_DIGEST_SIZE (32U)
+
+/**
+ * @brief Chunked SHA-256 and signature check exported by B0 to MCUboot as an external API.
+ *
+ * The image is passed through a small window in the shared_sram region:
+ * 1. hash_init() resets the hashing state kept in the window.
+ * 2. For each chunk of the image: copy up to B0_SHARED_CRYPTO_CHUNK_SIZE bytes to get_chunk_buf()
+ *    and call hash_update() with the number of copied bytes.
+ * 3. hash_finalize() writes the SHA-256 digest of the whole image to p_digest.
+ * 4. verify() checks the digest against the fw_validation_info of the image,
+ *    the public key against the keys provisioned for B0 and the signature.
+ *
+ * @note The functions are executed in the context of the caller, so they keep their state only in the window
+ *       and they do not use logging or any other B0 globals.
+ *       The address of the window must be taken from get_chunk_buf(), not derived from the layout,
+ *       because the size of the hashing state depends on the crypto backend of B0.
+ */
+struct b0_shared_crypto_ext_api
+{
+    uint8_t* (*get_chunk_buf)(void);
+    int (*hash_init)(void);
+    int (*hash_update)(const uint32_t len);
+    int (*hash_finalize)(uint8_t* const p_digest);
+    int (*verify)(const uint8_t* const p_digest, const struct fw_validation_info* const p_val_info);
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // B0_SHARED_CRYPTO_H
@@ -3,6 +3,7 @@
  */
 
 #include "b0_supercap.h"
+#include <zephyr/kernel.h>
 #include <zephyr/devicetree.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/sys/poweroff.h>
@@ -13,16 +14,17 @@
 
 LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
 
-#if defined(CONFIG_BOARD_RUUVI_RUUVIAIR_REV_1)
+#if B0_SUPERCAP_ENABLED
 
 #define SUPERCAP_ACTIVE_NODE DT_ALIAS(gpio_supercap_active)
-#if !DT_NODE_HAS_STATUS_OKAY(SUPERCAP_ACTIVE_NODE)
-#error "'gpio-supercap-active' devicetree alias is not defined"
-#endif
 
 static const struct gpio_dt_spec g_supercap_active = GPIO_DT_SPEC_GET(SUPERCAP_ACTIVE_NODE, gpios);
 static struct gpio_callback      g_supercap_active_isr_gpio_cb_data;
 
+static volatile bool     g_is_power_off_locked;
+static volatile bool     g_is_power_off_pending;
+static volatile uint32_t g_power_fail_timestamp;
+
 static __NO_RETURN void
 b0_on_supercap_active(void)
 {
@@ -33,6 +35,16 @@ b0_on_supercap_active(void)
     sys_poweroff();
 }
 
+static void
+b0_supercap_on_holdup_budget_expired(struct k_timer* p_timer)
+{
+    (void)p_timer;
+    // The page operation in progress has not finished in time, power off before the supercap is drained.
+    b0_on_supercap_active();
+}
+
+K_TIMER_DEFINE(g_supercap_holdup_timer, &b0_supercap_on_holdup_budget_expired, NULL);
+
 static void
 b0_isr_cb_supercap_active(const struct device* dev, struct gpio_callback* cb, uint32_t pins)
 {
@@ -40,6 +52,15 @@ b0_isr_cb_supercap_active(const struct device* dev, struct gpio_callback* cb, ui
     (void)cb;
     (void)pins;
 
+    if (g_is_power_off_locked)
+    {
+        // Let the flash operation in progress finish the current page, it will power off the device then.
+        (void)gpio_pin_interrupt_configure_dt(&g_supercap_active, GPIO_INT_DISABLE);
+        g_power_fail_timestamp = k_uptime_get_32();
+        g_is_power_off_pending = true;
+        k_timer_start(&g_supercap_holdup_timer, K_MSEC(B0_SUPERCAP_HOLDUP_BUDGET_MS), K_NO_WAIT);
+        return;
+    }
     b0_on_supercap_active();
 }
 
@@ -54,17 +75,68 @@ b0_supercap_init(void)
         &g_supercap_active_isr_gpio_cb_data,
         &b0_isr_cb_supercap_active,
         GPIO_INT_EDGE_FALLING);
+    if (b0_supercap_is_active())
+    {
+        b0_on_supercap_active();
+    }
+}
+
+bool
+b0_supercap_is_active(void)
+{
+    if (g_is_power_off_pending)
+    {
+        return true;
+    }
     int rc = gpio_pin_get_dt(&g_supercap_active);
     if (rc < 0)
     {
         LOG_ERR("%s: Failed to get GPIO_SUPERCAP_ACTIVE (rc: %d)", __func__, rc);
+        return false;
+    }
+    return !!rc;
+}
+
+void
+b0_supercap_lock_power_off(void)
+{
+    g_is_power_off_locked = true;
+}
+
+void
+b0_supercap_unlock_power_off(void)
+{
+    g_is_power_off_locked = false;
+    if (g_is_power_off_pending)
+    {
+        LOG_WRN("B0: Running on supercap - power off");
+        b0_on_supercap_active();
+    }
+}
+
+void
+b0_supercap_on_page_boundary(void)
+{
+    if (g_is_power_off_pending)
+    {
+        LOG_WRN("B0: Running on supercap - power off after finishing the current page");
+        b0_on_supercap_active();
+    }
+}
+
+void
+b0_supercap_on_slice(const uint32_t next_slice_ms)
+{
+    if (!g_is_power_off_pending)
+    {
         return;
     }
-    const bool is_supercap_active = !!rc;
-    if (is_supercap_active)
+    const uint32_t elapsed_ms = k_uptime_get_32() - g_power_fail_timestamp;
+    if ((elapsed_ms + next_slice_ms) > B0_SUPERCAP_HOLDUP_BUDGET_MS)
     {
+        LOG_WRN("B0: Running on supercap - power off, hold-up budget is not enough for the next slice");
         b0_on_supercap_active();
     }
 }
 
-#endif // CONFIG_BOARD_RUUVI_RUUVIAIR_REV_1
+#endif // B0_SUPERCAP_ENABLED
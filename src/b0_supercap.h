@@ -5,11 +5,27 @@
 #if !defined(B0_SUPERCAP_H)
 #define B0_SUPERCAP_H
 
+#include <stdint.h>
+#include <stdbool.h>
+#include <zephyr/devicetree.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
-#if defined(CONFIG_BOARD_RUUVI_RUUVIAIR_REV_1)
+/* The supercap power source is handled if the devicetree of the board has 'gpio-supercap-active' alias.
+ * Rev.1 boards must have it, on other boards (e.g. native_sim) it can point to an emulated GPIO. */
+#define B0_SUPERCAP_ENABLED DT_NODE_HAS_STATUS_OKAY(DT_ALIAS(gpio_supercap_active))
+
+#if defined(CONFIG_BOARD_RUUVI_RUUVIAIR_REV_1) && !B0_SUPERCAP_ENABLED
+#error "'gpio-supercap-active' devicetree alias is not defined"
+#endif
+
+/* The time the supercap keeps the device running after the main power has failed (hold-up budget).
+ * It is an estimate which must cover one page operation (an 85 ms page erase or a 4 KiB page write). */
+#define B0_SUPERCAP_HOLDUP_BUDGET_MS (150U)
+
+#if B0_SUPERCAP_ENABLED
 
 void
 b0_supercap_init(void);
@@ -17,7 +33,71 @@ b0_supercap_init(void);
 void
 b0_supercap_deinit(void);
 
-#endif // CONFIG_BOARD_RUUVI_RUUVIAIR_REV_1
+/**
+ * @brief Defer power-off on SUPERCAP_ACTIVE until the current flash page is finished.
+ * @note While deferred, the power-off happens in b0_supercap_on_page_boundary(), b0_supercap_on_slice(),
+ *       b0_supercap_unlock_power_off() or when B0_SUPERCAP_HOLDUP_BUDGET_MS expires.
+ */
+void
+b0_supercap_lock_power_off(void);
+
+/**
+ * @brief Allow immediate power-off on SUPERCAP_ACTIVE and power off now if it is pending.
+ */
+void
+b0_supercap_unlock_power_off(void);
+
+/**
+ * @brief Check if the device has switched to the supercap (i.e. the main power has failed).
+ */
+bool
+b0_supercap_is_active(void);
+
+/**
+ * @brief Called by the recovery engine between flash pages: power off if the supercap has become active.
+ */
+void
+b0_supercap_on_page_boundary(void);
+
+/**
+ * @brief Called between slices of a page operation: power off if the supercap is active
+ *        and the rest of the hold-up budget is not enough for the next slice.
+ * @note If the budget expires during a slice, the device is powered off from the timer interrupt.
+ * @param next_slice_ms - the duration of the next slice.
+ */
+void
+b0_supercap_on_slice(const uint32_t next_slice_ms);
+
+#else
+
+static inline void
+b0_supercap_lock_power_off(void)
+{
+}
+
+static inline void
+b0_supercap_unlock_power_off(void)
+{
+}
+
+static inline bool
+b0_supercap_is_active(void)
+{
+    return false;
+}
+
+static inline void
+b0_supercap_on_page_boundary(void)
+{
+}
+
+static inline void
+b0_supercap_on_slice(const uint32_t next_slice_ms)
+{
+    (void)next_slice_ms;
+}
+
+#endif // B0_SUPERCAP_ENABLED
 
 #ifdef __cplusplus
 }
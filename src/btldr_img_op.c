@@ -6,8 +6,10 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <zephyr/storage/flash_map.h>
+#include <zephyr/drivers/flash.h>
 #include <zephyr/logging/log.h>
 #include <cmsis_gcc.h>
+#include <fw_info_bare.h>
 #include "zephyr_api.h"
 
 LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
@@ -17,122 +19,226 @@ LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
 extern __NO_RETURN void
 on_factory_fw_recovery_fail(void);
 
-typedef bool (*cb_img_process_t)(
+typedef enum img_process_res_e
+{
+    IMG_PROCESS_RES_OK,
+    IMG_PROCESS_RES_MISMATCH,
+    IMG_PROCESS_RES_IO_ERR,
+} img_process_res_e;
+
+typedef struct img_pair_t
+{
+    const struct flash_area* p_fa_dst;
+    const struct flash_area* p_fa_src;
+} img_pair_t;
+
+typedef img_process_res_e (*cb_img_process_t)(
     const struct flash_area* p_fa_dst,
     const off_t              offset,
     const uint8_t*           p_src_img_data_buf,
-    const size_t             buf_len);
+    const size_t             buf_len,
+    void*                    p_ctx);
 
-static bool
-img_process(
-    const fa_id_t    fa_id_dst,
-    const fa_id_t    fa_id_src,
-    const bool       flag_erase_dst,
-    cb_img_process_t cb_img_process)
+static img_process_res_e
+img_open_pair(
+    const fa_id_t                   fa_id_dst,
+    const fa_id_t                   fa_id_src,
+    const struct flash_area** const pp_fa_dst,
+    const struct flash_area** const pp_fa_src)
 {
-    static uint8_t tmp_buf1[TMP_BUF_SIZE];
-
-    const struct flash_area* p_fa_dst = NULL;
-    const struct flash_area* p_fa_src = NULL;
-
-    int32_t rc = flash_area_open(fa_id_dst, &p_fa_dst);
+    int32_t rc = flash_area_open(fa_id_dst, pp_fa_dst);
     if (0 != rc)
     {
         LOG_ERR("Failed to open flash area %d, rc=%d", fa_id_dst, rc);
-        on_factory_fw_recovery_fail();
+        return IMG_PROCESS_RES_IO_ERR;
     }
 
-    rc = flash_area_open(fa_id_src, &p_fa_src);
+    rc = flash_area_open(fa_id_src, pp_fa_src);
     if (0 != rc)
     {
         LOG_ERR("Failed to open flash area %d, rc=%d", fa_id_src, rc);
-        on_factory_fw_recovery_fail();
+        flash_area_close(*pp_fa_dst);
+        return IMG_PROCESS_RES_IO_ERR;
     }
 
-    if (p_fa_dst->fa_size != p_fa_src->fa_size)
+    if ((*pp_fa_dst)->fa_size != (*pp_fa_src)->fa_size)
     {
-        LOG_ERR("Image size mismatch: %d != %d", p_fa_dst->fa_size, p_fa_src->fa_size);
-        on_factory_fw_recovery_fail();
+        LOG_ERR("Image size mismatch: %d != %d", (*pp_fa_dst)->fa_size, (*pp_fa_src)->fa_size);
+        flash_area_close(*pp_fa_src);
+        flash_area_close(*pp_fa_dst);
+        return IMG_PROCESS_RES_IO_ERR;
     }
+    return IMG_PROCESS_RES_OK;
+}
 
-    if (flag_erase_dst)
+static img_process_res_e
+img_get_page_range(
+    const struct flash_area* const p_fa,
+    const off_t                    offset,
+    off_t* const                   p_page_offset,
+    size_t* const                  p_page_size)
+{
+    struct flash_pages_info info = { 0 };
+
+    const int32_t rc = flash_get_page_info_by_offs(p_fa->fa_dev, (off_t)(p_fa->fa_off + offset), &info);
+    if (rc != 0)
     {
-        rc = flash_area_erase(p_fa_dst, 0, p_fa_dst->fa_size);
+        LOG_ERR("Failed to get page info at address 0x%08x, rc=%d", (unsigned)(p_fa->fa_off + offset), rc);
+        return IMG_PROCESS_RES_IO_ERR;
+    }
+    *p_page_offset = info.start_offset - (off_t)p_fa->fa_off;
+    *p_page_size   = info.size;
+    return IMG_PROCESS_RES_OK;
+}
+
+static img_process_res_e
+img_erase_range(const struct flash_area* const p_fa_dst, const off_t start_offset, const size_t total_len)
+{
+    /* Erase page by page, so that the recovery can react (e.g. to power failure) between pages. */
+    off_t       offset = start_offset;
+    const off_t end    = start_offset + (off_t)total_len;
+    while (offset < end)
+    {
+        off_t             page_offset = 0;
+        size_t            page_size   = 0;
+        img_process_res_e res         = img_get_page_range(p_fa_dst, offset, &page_offset, &page_size);
+        if (IMG_PROCESS_RES_OK != res)
+        {
+            return res;
+        }
+        const int32_t rc = btldr_img_op_erase_page(p_fa_dst, page_offset, page_size);
         if (rc != 0)
         {
             LOG_ERR(
                 "Failed to erase flash area %d (address 0x%08x, size 0x%08x), rc=%d",
-                fa_id_dst,
-                (unsigned)p_fa_dst->fa_off,
-                (unsigned)p_fa_dst->fa_size,
+                p_fa_dst->fa_id,
+                (unsigned)(p_fa_dst->fa_off + page_offset),
+                (unsigned)page_size,
                 rc);
-            on_factory_fw_recovery_fail();
+            return IMG_PROCESS_RES_IO_ERR;
         }
+        offset = page_offset + (off_t)page_size;
+        btldr_img_op_on_slice(BTLDR_IMG_OP_STAGE_ERASE, p_fa_dst, offset);
+        btldr_img_op_on_page_done();
     }
+    return IMG_PROCESS_RES_OK;
+}
 
-    bool   is_success = true;
-    size_t rem_len    = p_fa_src->fa_size;
-    off_t  offset     = 0;
+static img_process_res_e
+img_process_range(
+    const struct flash_area* const p_fa_dst,
+    const struct flash_area* const p_fa_src,
+    const off_t                    start_offset,
+    const size_t                   total_len,
+    cb_img_process_t               cb_img_process,
+    void*                          p_ctx)
+{
+    static uint8_t tmp_buf1[TMP_BUF_SIZE];
+
+    off_t             page_offset = 0;
+    size_t            page_size   = 0;
+    img_process_res_e res         = img_get_page_range(p_fa_dst, start_offset, &page_offset, &page_size);
+    size_t            rem_len     = (IMG_PROCESS_RES_OK == res) ? total_len : 0;
+    off_t             offset      = start_offset;
     while (rem_len > 0)
     {
         const size_t len = (rem_len > TMP_BUF_SIZE) ? TMP_BUF_SIZE : rem_len;
 
-        rc = flash_area_read(p_fa_src, offset, tmp_buf1, len);
+        const int32_t rc = flash_area_read(p_fa_src, offset, tmp_buf1, len);
         if (rc != 0)
         {
             LOG_ERR(
                 "Failed to read flash area %d, address 0x%08x, rc=%d",
-                fa_id_src,
+                p_fa_src->fa_id,
                 (unsigned)(p_fa_src->fa_off + offset),
                 rc);
-            on_factory_fw_recovery_fail();
+            res = IMG_PROCESS_RES_IO_ERR;
+            break;
         }
 
-        if (!cb_img_process(p_fa_dst, offset, tmp_buf1, len))
+        res = cb_img_process(p_fa_dst, offset, tmp_buf1, len, p_ctx);
+        if (IMG_PROCESS_RES_OK != res)
         {
-            is_success = false;
             break;
         }
 
         offset += len;
         rem_len -= len;
+        if (0 == ((offset - page_offset) % (off_t)page_size))
+        {
+            btldr_img_op_on_page_done();
+        }
+    }
+    return res;
+}
+
+static img_process_res_e
+img_process(
+    const fa_id_t    fa_id_dst,
+    const fa_id_t    fa_id_src,
+    const bool       flag_erase_dst,
+    cb_img_process_t cb_img_process,
+    void*            p_ctx)
+{
+    const struct flash_area* p_fa_dst = NULL;
+    const struct flash_area* p_fa_src = NULL;
+
+    img_process_res_e res = img_open_pair(fa_id_dst, fa_id_src, &p_fa_dst, &p_fa_src);
+    if (IMG_PROCESS_RES_OK != res)
+    {
+        return res;
+    }
+
+    if (flag_erase_dst)
+    {
+        res = img_erase_range(p_fa_dst, 0, p_fa_dst->fa_size);
+    }
+    if (IMG_PROCESS_RES_OK == res)
+    {
+        res = img_process_range(p_fa_dst, p_fa_src, 0, p_fa_src->fa_size, cb_img_process, p_ctx);
     }
 
     flash_area_close(p_fa_src);
     flash_area_close(p_fa_dst);
-    return is_success;
+    return res;
 }
 
-static bool
+static img_process_res_e
 cb_img_write(
     const struct flash_area* p_fa_dst,
     const off_t              offset,
     const uint8_t*           p_src_img_data_buf,
-    const size_t             buf_len)
+    const size_t             buf_len,
+    void*                    p_ctx)
 {
+    (void)p_ctx;
     zephyr_api_ret_t rc = flash_area_write(p_fa_dst, offset, p_src_img_data_buf, buf_len);
     if (rc != 0)
     {
         LOG_ERR("Failed to write at address 0x%08x, rc=%d", (unsigned)(p_fa_dst->fa_off + offset), rc);
-        on_factory_fw_recovery_fail();
+        return IMG_PROCESS_RES_IO_ERR;
     }
-    return true;
+    btldr_img_op_on_slice(BTLDR_IMG_OP_STAGE_WRITE, p_fa_dst, offset + (off_t)buf_len);
+    return IMG_PROCESS_RES_OK;
 }
 
-static bool
+static img_process_res_e
 cb_img_cmp(
     const struct flash_area* p_fa_dst,
     const off_t              offset,
     const uint8_t*           p_src_img_data_buf,
-    const size_t             buf_len)
+    const size_t             buf_len,
+    void*                    p_ctx)
 {
     static uint8_t tmp_buf2[TMP_BUF_SIZE];
 
+    btldr_img_op_cmp_stat_t* const p_stat = p_ctx;
+
     zephyr_api_ret_t rc = flash_area_read(p_fa_dst, offset, tmp_buf2, buf_len);
     if (rc != 0)
     {
         LOG_ERR("Failed to read flash at address 0x%08x, rc=%d", (unsigned)(p_fa_dst->fa_off + offset), rc);
-        on_factory_fw_recovery_fail();
+        return IMG_PROCESS_RES_IO_ERR;
     }
 
     if (memcmp(p_src_img_data_buf, tmp_buf2, buf_len) != 0)
@@ -140,19 +246,293 @@ cb_img_cmp(
         LOG_INF("memcmp failed at address 0x%08x", (unsigned)(p_fa_dst->fa_off + offset));
         LOG_HEXDUMP_DBG(p_src_img_data_buf, buf_len, "src:");
         LOG_HEXDUMP_DBG(tmp_buf2, buf_len, "dst:");
-        return false;
+        if (NULL == p_stat)
+        {
+            return IMG_PROCESS_RES_MISMATCH;
+        }
+        if (p_stat->num_offsets < p_stat->max_offsets)
+        {
+            p_stat->p_mismatch_offsets[p_stat->num_offsets] = (uint32_t)offset;
+            p_stat->num_offsets += 1;
+        }
+        p_stat->num_mismatches += 1;
     }
-    return true;
+    btldr_img_op_on_slice(BTLDR_IMG_OP_STAGE_VERIFY, p_fa_dst, offset + (off_t)buf_len);
+    return IMG_PROCESS_RES_OK;
+}
+
+static img_process_res_e
+cb_img_cmp_locate(
+    const struct flash_area* p_fa_dst,
+    const off_t              offset,
+    const uint8_t*           p_src_img_data_buf,
+    const size_t             buf_len,
+    void*                    p_ctx)
+{
+    off_t* const            p_mismatch_offset = p_ctx;
+    const img_process_res_e res = cb_img_cmp(p_fa_dst, offset, p_src_img_data_buf, buf_len, NULL);
+    if (IMG_PROCESS_RES_MISMATCH == res)
+    {
+        *p_mismatch_offset = offset;
+    }
+    return res;
+}
+
+/**
+ * @brief Verify the copied image and rewrite every page which does not match the source.
+ * @note Before each rewrite btldr_img_op_on_verify_mismatch() is called to let the caller make reading
+ *       of the source more reliable (e.g. by lowering the QSPI clock).
+ *       The verification fails if a page still does not match after it has been rewritten.
+ */
+static img_process_res_e
+img_verify_and_repair(const struct flash_area* const p_fa_dst, const struct flash_area* const p_fa_src)
+{
+    off_t offset           = 0;
+    off_t rewritten_offset = -1;
+    for (;;)
+    {
+        off_t             mismatch_offset = 0;
+        img_process_res_e res             = img_process_range(
+            p_fa_dst,
+            p_fa_src,
+            offset,
+            p_fa_src->fa_size - (size_t)offset,
+            &cb_img_cmp_locate,
+            &mismatch_offset);
+        if (IMG_PROCESS_RES_MISMATCH != res)
+        {
+            return res;
+        }
+        if (!btldr_img_op_on_verify_mismatch())
+        {
+            return IMG_PROCESS_RES_MISMATCH;
+        }
+
+        off_t  page_offset = 0;
+        size_t page_size   = 0;
+        res                = img_get_page_range(p_fa_dst, mismatch_offset, &page_offset, &page_size);
+        if (IMG_PROCESS_RES_OK != res)
+        {
+            return res;
+        }
+        if (page_offset == rewritten_offset)
+        {
+            LOG_ERR("Page at address 0x%08x does not match after rewrite", (unsigned)(p_fa_dst->fa_off + page_offset));
+            return IMG_PROCESS_RES_MISMATCH;
+        }
+        LOG_WRN(
+            "Rewrite page at address 0x%08x, size 0x%x",
+            (unsigned)(p_fa_dst->fa_off + page_offset),
+            (unsigned)page_size);
+        res = img_erase_range(p_fa_dst, page_offset, page_size);
+        if (IMG_PROCESS_RES_OK != res)
+        {
+            return res;
+        }
+        res = img_process_range(p_fa_dst, p_fa_src, page_offset, page_size, &cb_img_write, NULL);
+        if (IMG_PROCESS_RES_OK != res)
+        {
+            return res;
+        }
+        offset           = page_offset;
+        rewritten_offset = page_offset;
+    }
+}
+
+static bool
+img_is_adjacent(const img_pair_t* const p_prev, const img_pair_t* const p_next)
+{
+    return (p_prev->p_fa_dst->fa_dev == p_next->p_fa_dst->fa_dev)
+           && (p_prev->p_fa_src->fa_dev == p_next->p_fa_src->fa_dev)
+           && ((p_prev->p_fa_dst->fa_off + (off_t)p_prev->p_fa_dst->fa_size) == p_next->p_fa_dst->fa_off)
+           && ((p_prev->p_fa_src->fa_off + (off_t)p_prev->p_fa_src->fa_size) == p_next->p_fa_src->fa_off);
+}
+
+/**
+ * @brief Copy and verify images which are adjacent both in the destination and in the source.
+ * @note The run is streamed stage by stage (erase, write, verify) without switching to the verification
+ *       settings between the images, but every image is processed with its own flash areas,
+ *       so that the callbacks (e.g. checkpoints) refer to the real partition and the offset within it.
+ *       A page which does not match is rewritten when its image is verified, so a slower QSPI profile
+ *       selected by btldr_img_op_on_verify_mismatch() is used for writing only from the next run.
+ * @param p_jobs - results for each image, can be NULL.
+ */
+static img_process_res_e
+img_copy_and_verify_run(const img_pair_t* const p_pairs, btldr_img_op_job_t* const p_jobs, const uint32_t num_jobs)
+{
+    img_process_res_e res = IMG_PROCESS_RES_OK;
+    for (uint32_t i = 0; (i < num_jobs) && (IMG_PROCESS_RES_OK == res); ++i)
+    {
+        res = img_erase_range(p_pairs[i].p_fa_dst, 0, p_pairs[i].p_fa_dst->fa_size);
+    }
+    for (uint32_t i = 0; (i < num_jobs) && (IMG_PROCESS_RES_OK == res); ++i)
+    {
+        res = img_process_range(
+            p_pairs[i].p_fa_dst,
+            p_pairs[i].p_fa_src,
+            0,
+            p_pairs[i].p_fa_src->fa_size,
+            &cb_img_write,
+            NULL);
+    }
+    if (IMG_PROCESS_RES_OK != res)
+    {
+        return res;
+    }
+
+    btldr_img_op_on_verify_begin();
+    for (uint32_t i = 0; (i < num_jobs) && (IMG_PROCESS_RES_OK == res); ++i)
+    {
+        res = img_verify_and_repair(p_pairs[i].p_fa_dst, p_pairs[i].p_fa_src);
+        if (NULL != p_jobs)
+        {
+            p_jobs[i].is_verified = (IMG_PROCESS_RES_OK == res);
+        }
+    }
+    btldr_img_op_on_verify_end();
+    return res;
 }
 
 void
 btldr_img_op_copy(const fa_id_t fa_id_dst, const fa_id_t fa_id_src)
 {
-    img_process(fa_id_dst, fa_id_src, true, &cb_img_write);
+    if (IMG_PROCESS_RES_OK != img_process(fa_id_dst, fa_id_src, true, &cb_img_write, NULL))
+    {
+        on_factory_fw_recovery_fail();
+    }
 }
 
 bool
 btldr_img_op_cmp(const fa_id_t fa_id_dst, const fa_id_t fa_id_src)
 {
-    return img_process(fa_id_dst, fa_id_src, false, &cb_img_cmp);
+    const img_process_res_e res = img_process(fa_id_dst, fa_id_src, false, &cb_img_cmp, NULL);
+    if (IMG_PROCESS_RES_IO_ERR == res)
+    {
+        on_factory_fw_recovery_fail();
+    }
+    return IMG_PROCESS_RES_OK == res;
+}
+
+bool
+btldr_img_op_copy_and_verify(const fa_id_t fa_id_dst, const fa_id_t fa_id_src)
+{
+    img_pair_t pair = { 0 };
+
+    img_process_res_e res = img_open_pair(fa_id_dst, fa_id_src, &pair.p_fa_dst, &pair.p_fa_src);
+    if (IMG_PROCESS_RES_OK != res)
+    {
+        on_factory_fw_recovery_fail();
+    }
+    res = img_copy_and_verify_run(&pair, NULL, 1);
+
+    flash_area_close(pair.p_fa_src);
+    flash_area_close(pair.p_fa_dst);
+
+    if (IMG_PROCESS_RES_IO_ERR == res)
+    {
+        on_factory_fw_recovery_fail();
+    }
+    return IMG_PROCESS_RES_OK == res;
+}
+
+bool
+btldr_img_op_copy_and_verify_multi(btldr_img_op_job_t* const p_jobs, const uint32_t num_jobs)
+{
+    static img_pair_t pairs[BTLDR_IMG_OP_MAX_JOBS];
+
+    if (num_jobs > BTLDR_IMG_OP_MAX_JOBS)
+    {
+        LOG_ERR("Too many images to copy: %u", (unsigned)num_jobs);
+        on_factory_fw_recovery_fail();
+    }
+
+    img_process_res_e res        = IMG_PROCESS_RES_OK;
+    uint32_t          num_opened = 0;
+    for (; num_opened < num_jobs; ++num_opened)
+    {
+        p_jobs[num_opened].is_verified = false;
+        res                            = img_open_pair(
+            p_jobs[num_opened].fa_id_dst,
+            p_jobs[num_opened].fa_id_src,
+            &pairs[num_opened].p_fa_dst,
+            &pairs[num_opened].p_fa_src);
+        if (IMG_PROCESS_RES_OK != res)
+        {
+            break;
+        }
+    }
+
+    uint32_t run_begin = 0;
+    while ((IMG_PROCESS_RES_OK == res) && (run_begin < num_jobs))
+    {
+        uint32_t run_end = run_begin + 1;
+        while ((run_end < num_jobs) && img_is_adjacent(&pairs[run_end - 1], &pairs[run_end]))
+        {
+            run_end += 1;
+        }
+        LOG_INF(
+            "Stream %u image(s) as one run: %s..%s -> %s..%s",
+            (unsigned)(run_end - run_begin),
+            p_jobs[run_begin].p_fa_src_name,
+            p_jobs[run_end - 1].p_fa_src_name,
+            p_jobs[run_begin].p_fa_dst_name,
+            p_jobs[run_end - 1].p_fa_dst_name);
+        res       = img_copy_and_verify_run(&pairs[run_begin], &p_jobs[run_begin], run_end - run_begin);
+        run_begin = run_end;
+    }
+
+    for (uint32_t i = 0; i < num_opened; ++i)
+    {
+        flash_area_close(pairs[i].p_fa_src);
+        flash_area_close(pairs[i].p_fa_dst);
+    }
+
+    if (IMG_PROCESS_RES_IO_ERR == res)
+    {
+        on_factory_fw_recovery_fail();
+    }
+    return IMG_PROCESS_RES_OK == res;
+}
+
+bool
+btldr_img_op_cmp_all(const fa_id_t fa_id_dst, const fa_id_t fa_id_src, btldr_img_op_cmp_stat_t* const p_stat)
+{
+    p_stat->num_mismatches = 0;
+    p_stat->num_offsets    = 0;
+    return IMG_PROCESS_RES_OK == img_process(fa_id_dst, fa_id_src, false, &cb_img_cmp, p_stat);
+}
+
+bool
+btldr_img_op_check_fw_info(const fa_id_t fa_id, const char* const p_fa_name)
+{
+    static uint8_t           img_header_buf[FW_INFO_OFFSET4 + sizeof(struct fw_info)];
+    const struct flash_area* p_fa = NULL;
+    int32_t                  rc   = flash_area_open(fa_id, &p_fa);
+    if (0 != rc)
+    {
+        LOG_ERR("Failed to open flash area %d (%s), rc=%d", fa_id, p_fa_name, rc);
+        return false;
+    }
+    rc = flash_area_read(p_fa, (off_t)0, img_header_buf, sizeof(img_header_buf));
+    if (rc != 0)
+    {
+        LOG_ERR(
+            "Failed to read flash area %d (%s), address 0x%08x, size=%u, rc=%d",
+            fa_id,
+            p_fa_name,
+            (unsigned)p_fa->fa_off,
+            sizeof(img_header_buf),
+            rc);
+        flash_area_close(p_fa);
+        return false;
+    }
+    flash_area_close(p_fa);
+    const struct fw_info* const p_img_info = fw_info_find((uint32_t)img_header_buf);
+    if (NULL == p_img_info)
+    {
+        LOG_ERR("Failed to find fw_info for image in flash area %d (%s)", fa_id, p_fa_name);
+        return false;
+    }
+    LOG_INF("Check image in flash area %d (%s): OK", fa_id, p_fa_name);
+    return true;
 }
@@ -5,19 +5,134 @@
 #ifndef BTLDR_IMG_OP_H
 #define BTLDR_IMG_OP_H
 
+#include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <sys/types.h>
 #include "ruuvi_fa_id.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+typedef struct btldr_img_op_cmp_stat_t
+{
+    uint32_t* p_mismatch_offsets; //!< [in] Buffer for offsets of the first mismatching chunks
+    uint32_t  max_offsets;        //!< [in] Capacity of p_mismatch_offsets
+    uint32_t  num_offsets;        //!< [out] Number of offsets stored in p_mismatch_offsets
+    uint32_t  num_mismatches;     //!< [out] Total number of mismatching chunks
+} btldr_img_op_cmp_stat_t;
+
+#define BTLDR_IMG_OP_MAX_JOBS 8
+
+typedef struct btldr_img_op_job_t
+{
+    fa_id_t     fa_id_dst;     //!< [in] Destination flash area
+    const char* p_fa_dst_name; //!< [in] Name of the destination flash area (for logging)
+    fa_id_t     fa_id_src;     //!< [in] Source flash area
+    const char* p_fa_src_name; //!< [in] Name of the source flash area (for logging)
+    bool        is_verified;   //!< [out] The destination matches the source
+} btldr_img_op_job_t;
+
+struct flash_area;
+
+typedef enum btldr_img_op_stage_e
+{
+    BTLDR_IMG_OP_STAGE_ERASE,
+    BTLDR_IMG_OP_STAGE_WRITE,
+    BTLDR_IMG_OP_STAGE_VERIFY,
+} btldr_img_op_stage_e;
+
 void
 btldr_img_op_copy(const fa_id_t fa_id_dst, const fa_id_t fa_id_src);
 
 bool
 btldr_img_op_cmp(const fa_id_t fa_id_dst, const fa_id_t fa_id_src);
 
+/**
+ * @brief Copy the image and verify it, rewriting pages which do not match the source.
+ * @note The source is re-read only if btldr_img_op_on_verify_mismatch() allows it.
+ * @return true if the destination matches the source.
+ */
+bool
+btldr_img_op_copy_and_verify(const fa_id_t fa_id_dst, const fa_id_t fa_id_src);
+
+/**
+ * @brief Copy and verify a list of images like btldr_img_op_copy_and_verify().
+ * @note Consecutive jobs whose destinations and sources are both adjacent on the same flash devices are
+ *       streamed as one run: all of their pages are erased, then written, then verified in one pass,
+ *       with a single btldr_img_op_on_verify_begin()/btldr_img_op_on_verify_end() pair per run.
+ *       The callbacks always get the flash area of the job being processed and the offset within it.
+ * @param p_jobs - the jobs in the order of processing (at most BTLDR_IMG_OP_MAX_JOBS).
+ * @return true if all destinations match their sources (check is_verified of each job otherwise).
+ */
+bool
+btldr_img_op_copy_and_verify_multi(btldr_img_op_job_t* const p_jobs, const uint32_t num_jobs);
+
+/**
+ * @brief Compare the whole image without stopping at the first mismatch.
+ * @note Unlike btldr_img_op_cmp, I/O errors are reported to the caller instead of aborting the recovery.
+ * @return true if there were no I/O errors (check p_stat->num_mismatches for the comparison result).
+ */
+bool
+btldr_img_op_cmp_all(const fa_id_t fa_id_dst, const fa_id_t fa_id_src, btldr_img_op_cmp_stat_t* const p_stat);
+
+/**
+ * @brief Check that the flash area contains an image with a valid fw_info.
+ */
+bool
+btldr_img_op_check_fw_info(const fa_id_t fa_id, const char* const p_fa_name);
+
+/**
+ * @brief Called by btldr_img_op_copy_and_verify() when the copied data does not match the source.
+ * @note It is implemented by the user of this module.
+ * @return true if the source may be read again and the mismatching page should be rewritten.
+ */
+bool
+btldr_img_op_on_verify_mismatch(void);
+
+/**
+ * @brief Called by btldr_img_op_copy_and_verify() before the copied image is verified.
+ * @note It is implemented by the user of this module, e.g. to read the source with the most reliable
+ *       settings, so that the verification does not repeat a read error which has corrupted the copy.
+ *       Pages rewritten after a mismatch are also read with these settings.
+ */
+void
+btldr_img_op_on_verify_begin(void);
+
+/**
+ * @brief Called by btldr_img_op_copy_and_verify() after the verification has finished.
+ * @note It is implemented by the user of this module.
+ */
+void
+btldr_img_op_on_verify_end(void);
+
+/**
+ * @brief Called after each page of the destination has been erased or processed.
+ * @note It is implemented by the user of this module.
+ */
+void
+btldr_img_op_on_page_done(void);
+
+/**
+ * @brief Erase a page of the destination flash area.
+ * @note It is implemented by the user of this module, so that long erases can be split into slices
+ *       (btldr_img_op_on_slice() is expected to be called between them).
+ * @return 0 on success, negative error code otherwise.
+ */
+int
+btldr_img_op_erase_page(const struct flash_area* const p_fa, const off_t page_offset, const size_t page_size);
+
+/**
+ * @brief Called between slices of long flash operations (after each chunk written or verified).
+ * @note It is implemented by the user of this module, e.g. to store a checkpoint of the progress.
+ * @param stage - the current stage of the operation.
+ * @param p_fa - the destination flash area.
+ * @param offset - the offset in the destination flash area up to which the stage has been completed.
+ */
+void
+btldr_img_op_on_slice(const btldr_img_op_stage_e stage, const struct flash_area* const p_fa, const off_t offset);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,120 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "bl_crypto.h"
+#include <string.h>
+
+/* Plain SHA-256 (FIPS 180-4) as a replacement of the crypto backend of B0. */
+
+static const uint32_t g_sha256_k[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+    0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+    0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+    0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static uint32_t
+sha256_rotr(const uint32_t val, const uint32_t num_bits)
+{
+    return (val >> num_bits) | (val << (32U - num_bits));
+}
+
+static void
+sha256_process_block(bl_sha256_ctx_t* const p_ctx, const uint8_t* const p_block)
+{
+    uint32_t w[64];
+    for (uint32_t i = 0; i < 16; ++i)
+    {
+        w[i] = ((uint32_t)p_block[i * 4] << 24) | ((uint32_t)p_block[(i * 4) + 1] << 16)
+               | ((uint32_t)p_block[(i * 4) + 2] << 8) | (uint32_t)p_block[(i * 4) + 3];
+    }
+    for (uint32_t i = 16; i < 64; ++i)
+    {
+        const uint32_t s0 = sha256_rotr(w[i - 15], 7) ^ sha256_rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const uint32_t s1 = sha256_rotr(w[i - 2], 17) ^ sha256_rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i]              = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t v[8];
+    memcpy(v, p_ctx->state, sizeof(v));
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        const uint32_t s1  = sha256_rotr(v[4], 6) ^ sha256_rotr(v[4], 11) ^ sha256_rotr(v[4], 25);
+        const uint32_t ch  = (v[4] & v[5]) ^ (~v[4] & v[6]);
+        const uint32_t t1  = v[7] + s1 + ch + g_sha256_k[i] + w[i];
+        const uint32_t s0  = sha256_rotr(v[0], 2) ^ sha256_rotr(v[0], 13) ^ sha256_rotr(v[0], 22);
+        const uint32_t maj = (v[0] & v[1]) ^ (v[0] & v[2]) ^ (v[1] & v[2]);
+        memmove(&v[1], &v[0], 7 * sizeof(v[0]));
+        v[4] += t1;
+        v[0] = t1 + s0 + maj;
+    }
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        p_ctx->state[i] += v[i];
+    }
+}
+
+int
+bl_sha256_init(bl_sha256_ctx_t* p_ctx)
+{
+    static const uint32_t init_state[8] = {
+        0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+    };
+    memcpy(p_ctx->state, init_state, sizeof(init_state));
+    p_ctx->total_len = 0;
+    p_ctx->block_len = 0;
+    return 0;
+}
+
+int
+bl_sha256_update(bl_sha256_ctx_t* p_ctx, const uint8_t* p_data, uint32_t data_len)
+{
+    p_ctx->total_len += data_len;
+    while (data_len > 0)
+    {
+        const uint32_t len = ((64U - p_ctx->block_len) < data_len) ? (64U - p_ctx->block_len) : data_len;
+        memcpy(&p_ctx->block[p_ctx->block_len], p_data, len);
+        p_ctx->block_len += len;
+        p_data += len;
+        data_len -= len;
+        if (64U == p_ctx->block_len)
+        {
+            sha256_process_block(p_ctx, p_ctx->block);
+            p_ctx->block_len = 0;
+        }
+    }
+    return 0;
+}
+
+int
+bl_sha256_finalize(bl_sha256_ctx_t* p_ctx, uint8_t* p_output)
+{
+    const uint64_t total_bits = p_ctx->total_len * 8U;
+
+    p_ctx->block[p_ctx->block_len++] = 0x80U;
+    if (p_ctx->block_len > 56U)
+    {
+        memset(&p_ctx->block[p_ctx->block_len], 0, 64U - p_ctx->block_len);
+        sha256_process_block(p_ctx, p_ctx->block);
+        p_ctx->block_len = 0;
+    }
+    memset(&p_ctx->block[p_ctx->block_len], 0, 56U - p_ctx->block_len);
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        p_ctx->block[56 + i] = (uint8_t)(total_bits >> (56U - (i * 8U)));
+    }
+    sha256_process_block(p_ctx, p_ctx->block);
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        p_output[i * 4]       = (uint8_t)(p_ctx->state[i] >> 24);
+        p_output[(i * 4) + 1] = (uint8_t)(p_ctx->state[i] >> 16);
+        p_output[(i * 4) + 2] = (uint8_t)(p_ctx->state[i] >> 8);
+        p_output[(i * 4) + 3] = (uint8_t)p_ctx->state[i];
+    }
+    return 0;
+}
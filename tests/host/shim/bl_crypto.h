@@ -0,0 +1,45 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_BL_CRYPTO_H
+#define HOST_SHIM_BL_CRYPTO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct bl_sha256_ctx_t
+{
+    uint32_t state[8];
+    uint64_t total_len;
+    uint8_t  block[64];
+    uint32_t block_len;
+} bl_sha256_ctx_t;
+
+int
+bl_sha256_init(bl_sha256_ctx_t* p_ctx);
+
+int
+bl_sha256_update(bl_sha256_ctx_t* p_ctx, const uint8_t* p_data, uint32_t data_len);
+
+int
+bl_sha256_finalize(bl_sha256_ctx_t* p_ctx, uint8_t* p_output);
+
+/* Signature check is not implemented on the host, the result is set by the test. */
+int
+bl_secp256r1_validate(
+    const uint8_t* p_hash,
+    uint32_t       hash_len,
+    const uint8_t* p_public_key,
+    const uint8_t* p_signature);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_BL_CRYPTO_H
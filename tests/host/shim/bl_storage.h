@@ -0,0 +1,25 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_BL_STORAGE_H
+#define HOST_SHIM_BL_STORAGE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Provisioned public key hashes are set by the test. */
+uint32_t
+num_public_keys_read(void);
+
+int
+public_key_data_read(uint32_t key_idx, uint8_t* p_buf);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_BL_STORAGE_H
@@ -0,0 +1,23 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_BL_VALIDATION_H
+#define HOST_SHIM_BL_VALIDATION_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Signature validation is not implemented on the host, it is provided by the test. */
+bool
+bl_validate_firmware(uint32_t fw_dst_address, uint32_t fw_src_address);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_BL_VALIDATION_H
@@ -0,0 +1,28 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include <zephyr/sys/crc.h>
+
+#define HOST_SHIM_CRC32_IEEE_POLY (0xEDB88320U) // reversed 0x04C11DB7
+
+uint32_t
+crc32_ieee_update(uint32_t crc, const uint8_t* data, size_t len)
+{
+    crc = ~crc;
+    for (size_t i = 0; i < len; ++i)
+    {
+        crc ^= data[i];
+        for (uint32_t bit = 0; bit < 8U; ++bit)
+        {
+            crc = (0 != (crc & 1U)) ? ((crc >> 1U) ^ HOST_SHIM_CRC32_IEEE_POLY) : (crc >> 1U);
+        }
+    }
+    return ~crc;
+}
+
+uint32_t
+crc32_ieee(const uint8_t* data, size_t len)
+{
+    return crc32_ieee_update(0, data, len);
+}
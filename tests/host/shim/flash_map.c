@@ -0,0 +1,80 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include <zephyr/storage/flash_map.h>
+#include <errno.h>
+#include <string.h>
+
+uint8_t g_host_shim_flash[HOST_SHIM_FLASH_SIZE];
+
+static const struct flash_area g_host_shim_flash_areas[HOST_SHIM_FA_NUM] = {
+    [HOST_SHIM_FA_ID_s0] = { HOST_SHIM_FA_ID_s0, 0, PM_S0_ADDRESS, PM_S0_SIZE, NULL },
+    [HOST_SHIM_FA_ID_s1] = { HOST_SHIM_FA_ID_s1, 0, PM_S1_ADDRESS, PM_S1_SIZE, NULL },
+    [HOST_SHIM_FA_ID_mcuboot_primary] = {
+        HOST_SHIM_FA_ID_mcuboot_primary, 0, PM_MCUBOOT_PRIMARY_ADDRESS, PM_MCUBOOT_PRIMARY_SIZE, NULL,
+    },
+    [HOST_SHIM_FA_ID_mcuboot_secondary] = {
+        HOST_SHIM_FA_ID_mcuboot_secondary, 0, PM_MCUBOOT_SECONDARY_ADDRESS, PM_MCUBOOT_SECONDARY_SIZE, NULL,
+    },
+};
+
+static bool
+flash_area_is_in_range(const struct flash_area* fa, off_t off, size_t len)
+{
+    return (off >= 0) && (((size_t)off + len) <= fa->fa_size);
+}
+
+int
+flash_area_open(uint8_t id, const struct flash_area** fa)
+{
+    if (id >= HOST_SHIM_FA_NUM)
+    {
+        return -ENOENT;
+    }
+    *fa = &g_host_shim_flash_areas[id];
+    return 0;
+}
+
+void
+flash_area_close(const struct flash_area* fa)
+{
+    (void)fa;
+}
+
+int
+flash_area_read(const struct flash_area* fa, off_t off, void* dst, size_t len)
+{
+    if (!flash_area_is_in_range(fa, off, len))
+    {
+        return -EINVAL;
+    }
+    memcpy(dst, &g_host_shim_flash[fa->fa_off + off], len);
+    return 0;
+}
+
+int
+flash_area_write(const struct flash_area* fa, off_t off, const void* src, size_t len)
+{
+    if (!flash_area_is_in_range(fa, off, len))
+    {
+        return -EINVAL;
+    }
+    const uint8_t* const p_src = src;
+    for (size_t i = 0; i < len; ++i)
+    {
+        g_host_shim_flash[fa->fa_off + off + i] &= p_src[i];
+    }
+    return 0;
+}
+
+int
+flash_area_erase(const struct flash_area* fa, off_t off, size_t len)
+{
+    if (!flash_area_is_in_range(fa, off, len))
+    {
+        return -EINVAL;
+    }
+    memset(&g_host_shim_flash[fa->fa_off + off], 0xFF, len);
+    return 0;
+}
@@ -0,0 +1,20 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_FLASH_MAP_PM_H
+#define HOST_SHIM_FLASH_MAP_PM_H
+
+/* Partition Manager layout of the host flash (g_host_shim_flash), addresses are offsets in the buffer. */
+#define PM_S0_ADDRESS                (0x08000U)
+#define PM_S0_SIZE                   (0x08000U)
+#define PM_S1_ADDRESS                (0x10000U)
+#define PM_S1_SIZE                   (0x08000U)
+#define PM_MCUBOOT_PRIMARY_ADDRESS   (0x18000U)
+#define PM_MCUBOOT_PRIMARY_SIZE      (0x14000U)
+#define PM_MCUBOOT_SECONDARY_ADDRESS (0x2C000U)
+#define PM_MCUBOOT_SECONDARY_SIZE    (0x14000U)
+
+#define HOST_SHIM_FLASH_SIZE (0x40000U)
+
+#endif // HOST_SHIM_FLASH_MAP_PM_H
@@ -0,0 +1,49 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_FW_INFO_H
+#define HOST_SHIM_FW_INFO_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct __attribute__((packed)) fw_validation_info
+{
+    uint32_t magic[3];
+    uint32_t address;
+    uint8_t  hash[CONFIG_SB_HASH_LEN];
+    uint8_t  public_key[CONFIG_SB_SIGNATURE_PUBLIC_KEY_LEN];
+    uint8_t  signature[64];
+};
+
+struct fw_info_ext_api
+{
+    uint32_t ext_api_len;
+    uint32_t ext_api_id;
+    uint32_t ext_api_flags;
+    uint32_t ext_api_version;
+};
+
+/* Same usage as in NCS: EXT_API(id, type, name) = { <members of type> } }; */
+#define EXT_API(id, type, name) \
+    const struct \
+    { \
+        struct fw_info_ext_api header; \
+        type                   ext_api; \
+    } name = { .header = { \
+                   .ext_api_len     = sizeof(struct fw_info_ext_api) + sizeof(type), \
+                   .ext_api_id      = CONFIG_##id##_EXT_API_ID, \
+                   .ext_api_flags   = CONFIG_##id##_EXT_API_FLAGS, \
+                   .ext_api_version = CONFIG_##id##_EXT_API_VER, \
+               }, \
+               .ext_api
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_FW_INFO_H
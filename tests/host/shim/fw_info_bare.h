@@ -0,0 +1,44 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_FW_INFO_BARE_H
+#define HOST_SHIM_FW_INFO_BARE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Offsets and layout of fw_info as used by nRF Connect SDK (see nrf/include/fw_info_bare.h). */
+#define FW_INFO_OFFSET0 0x0
+#define FW_INFO_OFFSET1 0x200
+#define FW_INFO_OFFSET2 0x400
+#define FW_INFO_OFFSET3 0x800
+#define FW_INFO_OFFSET4 0x1000
+
+#define FW_INFO_MAGIC_LEN_WORDS 3
+
+struct __attribute__((__packed__)) fw_info
+{
+    uint32_t magic[FW_INFO_MAGIC_LEN_WORDS];
+    uint32_t size;
+    uint32_t version;
+    uint32_t address;
+    uint32_t boot_address;
+    uint32_t valid;
+    uint32_t reserved[4];
+    uint32_t ext_api_num;
+    uint32_t ext_api_request_num;
+};
+
+/* Finding fw_info in the emulated flash is not implemented on the host, it is provided by the test. */
+const struct fw_info*
+fw_info_find(uint32_t firmware_address);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_FW_INFO_BARE_H
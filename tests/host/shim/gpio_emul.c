@@ -0,0 +1,129 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include <errno.h>
+#include <string.h>
+
+#define HOST_SHIM_GPIO_EMUL_NUM_PINS      (32U)
+#define HOST_SHIM_GPIO_EMUL_MAX_CALLBACKS (4U)
+
+const struct device g_host_shim_gpio_emul_port = { .name = "gpio_emul" };
+
+static uint8_t               g_gpio_emul_levels[HOST_SHIM_GPIO_EMUL_NUM_PINS];
+static gpio_flags_t          g_gpio_emul_int_flags[HOST_SHIM_GPIO_EMUL_NUM_PINS];
+static struct gpio_callback* g_gpio_emul_callbacks[HOST_SHIM_GPIO_EMUL_MAX_CALLBACKS];
+
+static void
+gpio_emul_fire(const gpio_pin_t pin)
+{
+    for (uint32_t i = 0; i < HOST_SHIM_GPIO_EMUL_MAX_CALLBACKS; ++i)
+    {
+        struct gpio_callback* const p_cb = g_gpio_emul_callbacks[i];
+        if ((NULL != p_cb) && (0 != (p_cb->pin_mask & BIT(pin))))
+        {
+            p_cb->handler(&g_host_shim_gpio_emul_port, p_cb, BIT(pin));
+        }
+    }
+}
+
+static bool
+gpio_emul_is_level_triggered(const gpio_pin_t pin)
+{
+    const gpio_flags_t flags = g_gpio_emul_int_flags[pin];
+    if ((0 == (flags & GPIO_INT_ENABLE)) || (0 != (flags & GPIO_INT_EDGE)))
+    {
+        return false;
+    }
+    return (0 != g_gpio_emul_levels[pin]) ? (0 != (flags & GPIO_INT_HIGH_1)) : (0 != (flags & GPIO_INT_LOW_0));
+}
+
+int
+gpio_emul_input_set(const struct device* port, gpio_pin_t pin, int value)
+{
+    if ((&g_host_shim_gpio_emul_port != port) || (pin >= HOST_SHIM_GPIO_EMUL_NUM_PINS))
+    {
+        return -EINVAL;
+    }
+    const uint8_t      prev  = g_gpio_emul_levels[pin];
+    const gpio_flags_t flags = g_gpio_emul_int_flags[pin];
+    g_gpio_emul_levels[pin]  = (0 != value) ? 1U : 0U;
+
+    bool is_triggered = gpio_emul_is_level_triggered(pin);
+    if ((0 != (flags & GPIO_INT_ENABLE)) && (0 != (flags & GPIO_INT_EDGE)) && (prev != g_gpio_emul_levels[pin]))
+    {
+        is_triggered = (0 != g_gpio_emul_levels[pin]) ? (0 != (flags & GPIO_INT_HIGH_1))
+                                                      : (0 != (flags & GPIO_INT_LOW_0));
+    }
+    if (is_triggered)
+    {
+        gpio_emul_fire(pin);
+    }
+    return 0;
+}
+
+void
+host_shim_gpio_emul_reset(void)
+{
+    memset(g_gpio_emul_levels, 0, sizeof(g_gpio_emul_levels));
+    memset(g_gpio_emul_int_flags, 0, sizeof(g_gpio_emul_int_flags));
+    memset(g_gpio_emul_callbacks, 0, sizeof(g_gpio_emul_callbacks));
+}
+
+bool
+gpio_is_ready_dt(const struct gpio_dt_spec* spec)
+{
+    return &g_host_shim_gpio_emul_port == spec->port;
+}
+
+int
+gpio_pin_configure_dt(const struct gpio_dt_spec* spec, gpio_flags_t extra_flags)
+{
+    (void)extra_flags;
+    return (spec->pin < HOST_SHIM_GPIO_EMUL_NUM_PINS) ? 0 : -EINVAL;
+}
+
+int
+gpio_pin_interrupt_configure_dt(const struct gpio_dt_spec* spec, gpio_flags_t flags)
+{
+    if (spec->pin >= HOST_SHIM_GPIO_EMUL_NUM_PINS)
+    {
+        return -EINVAL;
+    }
+    g_gpio_emul_int_flags[spec->pin] = (0 != (flags & GPIO_INT_DISABLE)) ? 0 : flags;
+    return 0;
+}
+
+int
+gpio_pin_get_dt(const struct gpio_dt_spec* spec)
+{
+    if (spec->pin >= HOST_SHIM_GPIO_EMUL_NUM_PINS)
+    {
+        return -EINVAL;
+    }
+    const int level = g_gpio_emul_levels[spec->pin];
+    return (0 != (spec->dt_flags & GPIO_ACTIVE_LOW)) ? !level : level;
+}
+
+void
+gpio_init_callback(struct gpio_callback* callback, gpio_callback_handler_t handler, gpio_port_pins_t pin_mask)
+{
+    callback->handler  = handler;
+    callback->pin_mask = pin_mask;
+}
+
+int
+gpio_add_callback(const struct device* port, struct gpio_callback* callback)
+{
+    (void)port;
+    for (uint32_t i = 0; i < HOST_SHIM_GPIO_EMUL_MAX_CALLBACKS; ++i)
+    {
+        if (NULL == g_gpio_emul_callbacks[i])
+        {
+            g_gpio_emul_callbacks[i] = callback;
+            return 0;
+        }
+    }
+    return -ENOMEM;
+}
@@ -0,0 +1,7 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include <zephyr/devicetree.h>
+
+uint8_t g_host_shim_shared_sram[HOST_SHIM_SHARED_SRAM_SIZE];
@@ -0,0 +1,93 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include <zephyr/kernel.h>
+#include <stddef.h>
+#include <pthread.h>
+#include <unistd.h>
+
+static uint32_t        g_host_shim_uptime_ms;
+static struct k_timer* g_p_host_shim_timers;
+static pthread_mutex_t g_host_shim_irq_mutex;
+static pthread_once_t  g_host_shim_irq_mutex_once = PTHREAD_ONCE_INIT;
+
+void
+k_timer_start(struct k_timer* p_timer, k_timeout_t duration, k_timeout_t period)
+{
+    (void)period;
+    if (!p_timer->is_running)
+    {
+        p_timer->p_next       = g_p_host_shim_timers;
+        g_p_host_shim_timers = p_timer;
+    }
+    p_timer->is_running = true;
+    p_timer->expiry_ms  = k_uptime_get_32() + duration.ms;
+}
+
+void
+k_timer_stop(struct k_timer* p_timer)
+{
+    p_timer->is_running = false;
+}
+
+uint32_t
+k_uptime_get_32(void)
+{
+    return __atomic_load_n(&g_host_shim_uptime_ms, __ATOMIC_SEQ_CST);
+}
+
+void
+k_busy_wait(uint32_t usec_to_wait)
+{
+    (void)usleep(usec_to_wait);
+}
+
+static void
+host_shim_irq_mutex_init(void)
+{
+    pthread_mutexattr_t attr;
+    (void)pthread_mutexattr_init(&attr);
+    (void)pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    (void)pthread_mutex_init(&g_host_shim_irq_mutex, &attr);
+    (void)pthread_mutexattr_destroy(&attr);
+}
+
+unsigned int
+irq_lock(void)
+{
+    (void)pthread_once(&g_host_shim_irq_mutex_once, &host_shim_irq_mutex_init);
+    (void)pthread_mutex_lock(&g_host_shim_irq_mutex);
+    return 0;
+}
+
+void
+irq_unlock(unsigned int key)
+{
+    (void)key;
+    (void)pthread_mutex_unlock(&g_host_shim_irq_mutex);
+}
+
+void
+host_shim_k_uptime_advance(const uint32_t delta_ms)
+{
+    (void)__atomic_add_fetch(&g_host_shim_uptime_ms, delta_ms, __ATOMIC_SEQ_CST);
+    for (struct k_timer* p_timer = g_p_host_shim_timers; NULL != p_timer; p_timer = p_timer->p_next)
+    {
+        if (p_timer->is_running && ((int32_t)(k_uptime_get_32() - p_timer->expiry_ms) >= 0))
+        {
+            p_timer->is_running = false;
+            p_timer->expiry_fn(p_timer);
+        }
+    }
+}
+
+void
+host_shim_k_reset(void)
+{
+    for (struct k_timer* p_timer = g_p_host_shim_timers; NULL != p_timer; p_timer = p_timer->p_next)
+    {
+        p_timer->is_running = false;
+    }
+    g_p_host_shim_timers = NULL;
+}
@@ -0,0 +1,13 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_RUUVI_FA_ID_H
+#define HOST_SHIM_RUUVI_FA_ID_H
+
+#include <stdint.h>
+
+/* On the host flash area IDs are the HOST_SHIM_FA_ID_* values of zephyr/storage/flash_map.h. */
+typedef uint8_t fa_id_t;
+
+#endif // HOST_SHIM_RUUVI_FA_ID_H
@@ -0,0 +1,242 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include <zephyr/drivers/uart.h>
+#include <zephyr/kernel.h>
+#include <errno.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#define HOST_SHIM_UART_EMUL_POLL_MS      (5)
+#define HOST_SHIM_UART_EMUL_IDLE_WAIT_US (1000U)
+#define HOST_SHIM_UART_EMUL_BAUDRATE     (115200U)
+
+const struct device g_host_shim_uart_emul_dev = { .name = "uart_emul" };
+
+static int                g_uart_emul_fd = -1;
+static bool               g_uart_emul_is_attached;
+static pthread_t          g_uart_emul_rx_thread;
+static uart_callback_t    g_uart_emul_callback;
+static void*              g_uart_emul_user_data;
+static struct uart_config g_uart_emul_cfg = { .baudrate = HOST_SHIM_UART_EMUL_BAUDRATE };
+static uint8_t*           g_p_uart_emul_rx_buf;
+static size_t             g_uart_emul_rx_buf_len;
+static size_t             g_uart_emul_rx_offset;
+static uint8_t*           g_p_uart_emul_rx_buf_next;
+static size_t             g_uart_emul_rx_buf_next_len;
+
+static void
+uart_emul_notify(struct uart_event* const p_evt)
+{
+    if (NULL != g_uart_emul_callback)
+    {
+        g_uart_emul_callback(&g_host_shim_uart_emul_dev, p_evt, g_uart_emul_user_data);
+    }
+}
+
+static void
+uart_emul_notify_type(const enum uart_event_type type)
+{
+    struct uart_event evt = { .type = type };
+    uart_emul_notify(&evt);
+}
+
+/**
+ * @brief Switch to the next RX buffer when the current one is full, like UARTE does on ENDRX.
+ * @note Called with the interrupt lock taken.
+ */
+static void
+uart_emul_rx_buf_full(void)
+{
+    struct uart_event evt = { .type = UART_RX_BUF_RELEASED, .data.rx_buf.buf = g_p_uart_emul_rx_buf };
+    uart_emul_notify(&evt);
+    g_p_uart_emul_rx_buf        = g_p_uart_emul_rx_buf_next;
+    g_uart_emul_rx_buf_len      = g_uart_emul_rx_buf_next_len;
+    g_uart_emul_rx_offset       = 0;
+    g_p_uart_emul_rx_buf_next   = NULL;
+    g_uart_emul_rx_buf_next_len = 0;
+    if (NULL == g_p_uart_emul_rx_buf)
+    {
+        uart_emul_notify_type(UART_RX_DISABLED);
+        return;
+    }
+    uart_emul_notify_type(UART_RX_BUF_REQUEST);
+}
+
+/**
+ * @brief Receive the available bytes into the current RX buffer.
+ * @return true if any bytes have been received.
+ */
+static bool
+uart_emul_rx_receive(void)
+{
+    const unsigned int key         = irq_lock();
+    bool               is_received = false;
+    if (NULL != g_p_uart_emul_rx_buf)
+    {
+        const ssize_t len = read(
+            g_uart_emul_fd,
+            &g_p_uart_emul_rx_buf[g_uart_emul_rx_offset],
+            g_uart_emul_rx_buf_len - g_uart_emul_rx_offset);
+        if (len > 0)
+        {
+            struct uart_event evt = {
+                .type = UART_RX_RDY,
+                .data.rx = { .buf = g_p_uart_emul_rx_buf, .offset = g_uart_emul_rx_offset, .len = (size_t)len },
+            };
+            g_uart_emul_rx_offset += (size_t)len;
+            uart_emul_notify(&evt);
+            if (g_uart_emul_rx_offset == g_uart_emul_rx_buf_len)
+            {
+                uart_emul_rx_buf_full();
+            }
+            is_received = true;
+        }
+    }
+    irq_unlock(key);
+    return is_received;
+}
+
+static void*
+uart_emul_rx_thread(void* p_arg)
+{
+    (void)p_arg;
+    while (__atomic_load_n(&g_uart_emul_is_attached, __ATOMIC_SEQ_CST))
+    {
+        struct pollfd pfd = { .fd = g_uart_emul_fd, .events = POLLIN };
+        if ((poll(&pfd, 1, HOST_SHIM_UART_EMUL_POLL_MS) <= 0) || (0 == (pfd.revents & POLLIN))
+            || !uart_emul_rx_receive())
+        {
+            // Nothing received (or RX is disabled and the bytes wait in the descriptor), do not spin
+            (void)usleep(HOST_SHIM_UART_EMUL_IDLE_WAIT_US);
+        }
+    }
+    return NULL;
+}
+
+int
+uart_callback_set(const struct device* dev, uart_callback_t callback, void* user_data)
+{
+    (void)dev;
+    const unsigned int key = irq_lock();
+    g_uart_emul_callback   = callback;
+    g_uart_emul_user_data  = user_data;
+    irq_unlock(key);
+    return 0;
+}
+
+int
+uart_tx(const struct device* dev, const uint8_t* buf, size_t len, int32_t timeout)
+{
+    (void)dev;
+    (void)timeout;
+    size_t offset = 0;
+    while (offset < len)
+    {
+        const ssize_t written = write(g_uart_emul_fd, &buf[offset], len - offset);
+        if (written < 0)
+        {
+            return -EIO;
+        }
+        offset += (size_t)written;
+    }
+    const unsigned int key = irq_lock();
+    struct uart_event  evt = { .type = UART_TX_DONE, .data.tx = { .buf = buf, .len = len } };
+    uart_emul_notify(&evt);
+    irq_unlock(key);
+    return 0;
+}
+
+int
+uart_tx_abort(const struct device* dev)
+{
+    (void)dev;
+    return -EFAULT; // uart_tx() completes synchronously, there is nothing to abort
+}
+
+int
+uart_rx_enable(const struct device* dev, uint8_t* buf, size_t len, int32_t timeout)
+{
+    (void)dev;
+    (void)timeout;
+    const unsigned int key = irq_lock();
+    if (NULL != g_p_uart_emul_rx_buf)
+    {
+        irq_unlock(key);
+        return -EBUSY;
+    }
+    g_p_uart_emul_rx_buf   = buf;
+    g_uart_emul_rx_buf_len = len;
+    g_uart_emul_rx_offset  = 0;
+    uart_emul_notify_type(UART_RX_BUF_REQUEST);
+    irq_unlock(key);
+    return 0;
+}
+
+int
+uart_rx_buf_rsp(const struct device* dev, uint8_t* buf, size_t len)
+{
+    (void)dev;
+    const unsigned int key      = irq_lock();
+    g_p_uart_emul_rx_buf_next   = buf;
+    g_uart_emul_rx_buf_next_len = len;
+    irq_unlock(key);
+    return 0;
+}
+
+int
+uart_rx_disable(const struct device* dev)
+{
+    (void)dev;
+    const unsigned int key = irq_lock();
+    if (NULL == g_p_uart_emul_rx_buf)
+    {
+        irq_unlock(key);
+        return -EFAULT;
+    }
+    g_p_uart_emul_rx_buf        = NULL;
+    g_p_uart_emul_rx_buf_next   = NULL;
+    g_uart_emul_rx_buf_next_len = 0;
+    uart_emul_notify_type(UART_RX_DISABLED);
+    irq_unlock(key);
+    return 0;
+}
+
+int
+uart_config_get(const struct device* dev, struct uart_config* cfg)
+{
+    (void)dev;
+    *cfg = g_uart_emul_cfg;
+    return 0;
+}
+
+int
+uart_configure(const struct device* dev, const struct uart_config* cfg)
+{
+    (void)dev;
+    g_uart_emul_cfg = *cfg;
+    return 0;
+}
+
+void
+host_shim_uart_emul_attach(const int fd)
+{
+    g_uart_emul_fd = fd;
+    __atomic_store_n(&g_uart_emul_is_attached, true, __ATOMIC_SEQ_CST);
+    (void)pthread_create(&g_uart_emul_rx_thread, NULL, &uart_emul_rx_thread, NULL);
+}
+
+void
+host_shim_uart_emul_detach(void)
+{
+    __atomic_store_n(&g_uart_emul_is_attached, false, __ATOMIC_SEQ_CST);
+    (void)pthread_join(g_uart_emul_rx_thread, NULL);
+    g_uart_emul_fd        = -1;
+    g_uart_emul_cfg       = (struct uart_config) { .baudrate = HOST_SHIM_UART_EMUL_BAUDRATE };
+    g_p_uart_emul_rx_buf  = NULL;
+    g_uart_emul_callback  = NULL;
+    g_uart_emul_user_data = NULL;
+}
@@ -0,0 +1,35 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_DEVICE_H
+#define HOST_SHIM_ZEPHYR_DEVICE_H
+
+#include <stdbool.h>
+#include <zephyr/devicetree.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct device
+{
+    const char* name;
+};
+
+/* The only device referenced by DEVICE_DT_GET() on the host is the emulated UART (see zephyr/drivers/uart.h). */
+#define DEVICE_DT_GET(node_id) (&g_host_shim_uart_emul_dev)
+
+extern const struct device g_host_shim_uart_emul_dev;
+
+static inline bool
+device_is_ready(const struct device* dev)
+{
+    return NULL != dev;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_ZEPHYR_DEVICE_H
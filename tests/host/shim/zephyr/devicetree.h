@@ -0,0 +1,48 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_DEVICETREE_H
+#define HOST_SHIM_ZEPHYR_DEVICETREE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define HOST_SHIM_SHARED_SRAM_SIZE (0x2000U)
+
+/* Every node label refers to shared_sram, which is backed by a buffer of the test. */
+#define DT_NODELABEL(label) label
+#define DT_REG_ADDR(node)   ((uintptr_t)&g_host_shim_shared_sram[0])
+#define DT_REG_SIZE(node)   HOST_SHIM_SHARED_SRAM_SIZE
+
+/* Aliases of the board which exist on the host, their GPIOs are pins of the emulated GPIO port. */
+#define DT_ALIAS(alias)                DT_ALIAS_##alias
+#define DT_ALIAS_gpio_supercap_active  gpio_supercap_active
+#define DT_NODE_HAS_STATUS_OKAY(node)  DT_NODE_HAS_STATUS_OKAY_(node)
+#define DT_NODE_HAS_STATUS_OKAY_(node) HOST_SHIM_NODE_OKAY_##node
+
+#define HOST_SHIM_NODE_OKAY_gpio_supercap_active 1
+
+/* Chosen nodes of the board which exist on the host, every UART is the emulated one (see zephyr/device.h). */
+#define DT_CHOSEN(prop)                                       prop
+#define DT_HAS_CHOSEN(prop)                                   DT_HAS_CHOSEN_(prop)
+#define DT_HAS_CHOSEN_(prop)                                  HOST_SHIM_HAS_CHOSEN_##prop
+#define HOST_SHIM_HAS_CHOSEN_ruuvi_b0_serial_recovery         1
+#define DT_PROP(node, prop)                                   DT_PROP_(node, prop)
+#define DT_PROP_(node, prop)                                  HOST_SHIM_PROP_##node##_##prop
+#define HOST_SHIM_PROP_ruuvi_b0_serial_recovery_current_speed 115200U
+
+#define HOST_SHIM_GPIO_PIN(node)                HOST_SHIM_GPIO_PIN_(node)
+#define HOST_SHIM_GPIO_PIN_(node)               HOST_SHIM_GPIO_PIN_##node
+#define HOST_SHIM_GPIO_PIN_gpio_supercap_active 3
+
+extern uint8_t g_host_shim_shared_sram[HOST_SHIM_SHARED_SRAM_SIZE];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_ZEPHYR_DEVICETREE_H
@@ -0,0 +1,84 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_DRIVERS_GPIO_H
+#define HOST_SHIM_ZEPHYR_DRIVERS_GPIO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <zephyr/devicetree.h>
+#include <zephyr/device.h>
+#include <zephyr/sys/util.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t gpio_flags_t;
+typedef uint8_t  gpio_pin_t;
+typedef uint32_t gpio_port_pins_t;
+
+#define GPIO_ACTIVE_LOW (1U << 0)
+#define GPIO_INPUT      (1U << 16)
+
+#define GPIO_INT_DISABLE (1U << 21)
+#define GPIO_INT_ENABLE  (1U << 22)
+#define GPIO_INT_EDGE    (1U << 24)
+#define GPIO_INT_LOW_0   (1U << 25)
+#define GPIO_INT_HIGH_1  (1U << 26)
+
+#define GPIO_INT_EDGE_FALLING (GPIO_INT_ENABLE | GPIO_INT_EDGE | GPIO_INT_LOW_0)
+#define GPIO_INT_EDGE_RISING  (GPIO_INT_ENABLE | GPIO_INT_EDGE | GPIO_INT_HIGH_1)
+#define GPIO_INT_LEVEL_HIGH   (GPIO_INT_ENABLE | GPIO_INT_HIGH_1)
+#define GPIO_INT_LEVEL_LOW    (GPIO_INT_ENABLE | GPIO_INT_LOW_0)
+
+struct gpio_callback;
+
+typedef void (*gpio_callback_handler_t)(const struct device* port, struct gpio_callback* cb, gpio_port_pins_t pins);
+
+struct gpio_callback
+{
+    gpio_callback_handler_t handler;
+    gpio_port_pins_t        pin_mask;
+};
+
+struct gpio_dt_spec
+{
+    const struct device* port;
+    gpio_pin_t           pin;
+    gpio_flags_t         dt_flags;
+};
+
+/* Every GPIO of the devicetree is an active-low pin of the emulated GPIO port (see zephyr/devicetree.h). */
+#define GPIO_DT_SPEC_GET(node_id, prop) \
+    { \
+        .port = &g_host_shim_gpio_emul_port, .pin = HOST_SHIM_GPIO_PIN(node_id), .dt_flags = GPIO_ACTIVE_LOW, \
+    }
+
+extern const struct device g_host_shim_gpio_emul_port;
+
+bool
+gpio_is_ready_dt(const struct gpio_dt_spec* spec);
+
+int
+gpio_pin_configure_dt(const struct gpio_dt_spec* spec, gpio_flags_t extra_flags);
+
+int
+gpio_pin_interrupt_configure_dt(const struct gpio_dt_spec* spec, gpio_flags_t flags);
+
+int
+gpio_pin_get_dt(const struct gpio_dt_spec* spec);
+
+void
+gpio_init_callback(struct gpio_callback* callback, gpio_callback_handler_t handler, gpio_port_pins_t pin_mask);
+
+int
+gpio_add_callback(const struct device* port, struct gpio_callback* callback);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_ZEPHYR_DRIVERS_GPIO_H
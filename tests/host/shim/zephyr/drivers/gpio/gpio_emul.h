@@ -0,0 +1,28 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_DRIVERS_GPIO_GPIO_EMUL_H
+#define HOST_SHIM_ZEPHYR_DRIVERS_GPIO_GPIO_EMUL_H
+
+#include <zephyr/drivers/gpio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Set the physical level of an input pin of the emulated port (same as in Zephyr gpio_emul).
+ * @note The registered callbacks are called if the change matches the configured interrupt.
+ */
+int
+gpio_emul_input_set(const struct device* port, gpio_pin_t pin, int value);
+
+void
+host_shim_gpio_emul_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_ZEPHYR_DRIVERS_GPIO_GPIO_EMUL_H
@@ -0,0 +1,110 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_DRIVERS_UART_H
+#define HOST_SHIM_ZEPHYR_DRIVERS_UART_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <zephyr/device.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Asynchronous UART API of Zephyr, implemented by the emulated UART on top of a file descriptor
+ * (e.g. the master side of a pseudo-terminal). Events are delivered with the interrupt lock taken (see irq_lock()):
+ * received data from the RX thread, TX_DONE as soon as uart_tx() has written the data to the descriptor. */
+enum uart_event_type
+{
+    UART_TX_DONE,
+    UART_TX_ABORTED,
+    UART_RX_RDY,
+    UART_RX_BUF_REQUEST,
+    UART_RX_BUF_RELEASED,
+    UART_RX_DISABLED,
+    UART_RX_STOPPED,
+};
+
+struct uart_event_tx
+{
+    const uint8_t* buf;
+    size_t         len;
+};
+
+struct uart_event_rx
+{
+    uint8_t* buf;
+    size_t   offset;
+    size_t   len;
+};
+
+struct uart_event_rx_buf
+{
+    uint8_t* buf;
+};
+
+struct uart_event
+{
+    enum uart_event_type type;
+    union
+    {
+        struct uart_event_tx     tx;
+        struct uart_event_rx     rx;
+        struct uart_event_rx_buf rx_buf;
+    } data;
+};
+
+typedef void (*uart_callback_t)(const struct device* dev, struct uart_event* evt, void* user_data);
+
+struct uart_config
+{
+    uint32_t baudrate;
+    uint8_t  parity;
+    uint8_t  stop_bits;
+    uint8_t  data_bits;
+    uint8_t  flow_ctrl;
+};
+
+int
+uart_callback_set(const struct device* dev, uart_callback_t callback, void* user_data);
+
+int
+uart_tx(const struct device* dev, const uint8_t* buf, size_t len, int32_t timeout);
+
+int
+uart_tx_abort(const struct device* dev);
+
+int
+uart_rx_enable(const struct device* dev, uint8_t* buf, size_t len, int32_t timeout);
+
+int
+uart_rx_buf_rsp(const struct device* dev, uint8_t* buf, size_t len);
+
+int
+uart_rx_disable(const struct device* dev);
+
+int
+uart_config_get(const struct device* dev, struct uart_config* cfg);
+
+int
+uart_configure(const struct device* dev, const struct uart_config* cfg);
+
+/**
+ * @brief Connect the emulated UART to the file descriptor and start the RX thread.
+ */
+void
+host_shim_uart_emul_attach(const int fd);
+
+/**
+ * @brief Stop the RX thread and disconnect the emulated UART.
+ */
+void
+host_shim_uart_emul_detach(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_ZEPHYR_DRIVERS_UART_H
@@ -0,0 +1,73 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_KERNEL_H
+#define HOST_SHIM_ZEPHYR_KERNEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <zephyr/toolchain.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct k_timeout_t
+{
+    uint32_t ms;
+} k_timeout_t;
+
+#define K_MSEC(t_ms) ((k_timeout_t) { .ms = (t_ms) })
+#define K_NO_WAIT  K_MSEC(0)
+
+#define SYS_FOREVER_US (-1)
+
+struct k_timer;
+
+typedef void (*k_timer_expiry_t)(struct k_timer* p_timer);
+
+/* Timers do not run by themselves on the host: the test advances the uptime with host_shim_k_uptime_advance(),
+ * which calls the expiry function of every started timer whose duration has elapsed. */
+struct k_timer
+{
+    k_timer_expiry_t expiry_fn;
+    bool             is_running;
+    uint32_t         expiry_ms;
+    struct k_timer*  p_next;
+};
+
+#define K_TIMER_DEFINE(name, expiry_fn_, stop_fn) struct k_timer name = { .expiry_fn = (expiry_fn_) }
+
+void
+k_timer_start(struct k_timer* p_timer, k_timeout_t duration, k_timeout_t period);
+
+void
+k_timer_stop(struct k_timer* p_timer);
+
+uint32_t
+k_uptime_get_32(void);
+
+/* Busy waiting sleeps in real time, it does not advance the uptime. */
+void
+k_busy_wait(uint32_t usec_to_wait);
+
+/* Interrupts are emulated by threads (e.g. the RX thread of the emulated UART), which run the handlers
+ * with the interrupt lock taken, so irq_lock() serializes the code with them. The lock is recursive. */
+unsigned int
+irq_lock(void);
+
+void
+irq_unlock(unsigned int key);
+
+void
+host_shim_k_uptime_advance(const uint32_t delta_ms);
+
+void
+host_shim_k_reset(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_ZEPHYR_KERNEL_H
@@ -0,0 +1,10 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_LINKER_DEVICETREE_REGIONS_H
+#define HOST_SHIM_ZEPHYR_LINKER_DEVICETREE_REGIONS_H
+
+#define LINKER_DT_NODE_REGION_NAME(node) #node
+
+#endif // HOST_SHIM_ZEPHYR_LINKER_DEVICETREE_REGIONS_H
@@ -0,0 +1,30 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_LOGGING_LOG_H
+#define HOST_SHIM_ZEPHYR_LOGGING_LOG_H
+
+#include <stdio.h>
+
+#define LOG_LEVEL_ERR 1
+#define LOG_LEVEL_WRN 2
+#define LOG_LEVEL_INF 3
+#define LOG_LEVEL_DBG 4
+
+#define LOG_MODULE_DECLARE(name, level)  extern int host_shim_log_module_##name
+#define LOG_MODULE_REGISTER(name, level) int host_shim_log_module_##name
+
+#define HOST_SHIM_LOG(level, ...) \
+    do \
+    { \
+        (void)printf("<" level "> " __VA_ARGS__); \
+        (void)printf("\n"); \
+    } while (0)
+
+#define LOG_ERR(...) HOST_SHIM_LOG("err", __VA_ARGS__)
+#define LOG_WRN(...) HOST_SHIM_LOG("wrn", __VA_ARGS__)
+#define LOG_INF(...) HOST_SHIM_LOG("inf", __VA_ARGS__)
+#define LOG_DBG(...) HOST_SHIM_LOG("dbg", __VA_ARGS__)
+
+#endif // HOST_SHIM_ZEPHYR_LOGGING_LOG_H
@@ -0,0 +1,64 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_STORAGE_FLASH_MAP_H
+#define HOST_SHIM_ZEPHYR_STORAGE_FLASH_MAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <zephyr/device.h>
+#include <flash_map_pm.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* The partitions of flash_map_pm.h in the internal flash, which is backed by g_host_shim_flash.
+ * Memory-mapped reads use CONFIG_FLASH_BASE_ADDRESS, which the test defines as the address of the buffer. */
+#define FIXED_PARTITION_ID(label) HOST_SHIM_FA_ID_##label
+
+enum
+{
+    HOST_SHIM_FA_ID_s0,
+    HOST_SHIM_FA_ID_s1,
+    HOST_SHIM_FA_ID_mcuboot_primary,
+    HOST_SHIM_FA_ID_mcuboot_secondary,
+    HOST_SHIM_FA_NUM,
+};
+
+struct flash_area
+{
+    uint8_t              fa_id;
+    uint8_t              device_id;
+    off_t                fa_off;
+    size_t               fa_size;
+    const struct device* fa_dev;
+};
+
+extern uint8_t g_host_shim_flash[HOST_SHIM_FLASH_SIZE];
+
+int
+flash_area_open(uint8_t id, const struct flash_area** fa);
+
+void
+flash_area_close(const struct flash_area* fa);
+
+int
+flash_area_read(const struct flash_area* fa, off_t off, void* dst, size_t len);
+
+/**
+ * @brief Program the flash like NOR flash does: bits can only be cleared, the page must be erased first.
+ */
+int
+flash_area_write(const struct flash_area* fa, off_t off, const void* src, size_t len);
+
+int
+flash_area_erase(const struct flash_area* fa, off_t off, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_ZEPHYR_STORAGE_FLASH_MAP_H
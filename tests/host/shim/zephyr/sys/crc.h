@@ -0,0 +1,25 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_SYS_CRC_H
+#define HOST_SHIM_ZEPHYR_SYS_CRC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+uint32_t
+crc32_ieee_update(uint32_t crc, const uint8_t* data, size_t len);
+
+uint32_t
+crc32_ieee(const uint8_t* data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_ZEPHYR_SYS_CRC_H
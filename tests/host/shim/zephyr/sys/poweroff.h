@@ -0,0 +1,22 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_SYS_POWEROFF_H
+#define HOST_SHIM_ZEPHYR_SYS_POWEROFF_H
+
+#include <zephyr/toolchain.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Implemented by the test (e.g. with longjmp back to the test case). */
+__NO_RETURN void
+sys_poweroff(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_ZEPHYR_SYS_POWEROFF_H
@@ -0,0 +1,65 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_SYS_RING_BUFFER_H
+#define HOST_SHIM_ZEPHYR_SYS_RING_BUFFER_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Byte ring buffer with the same semantics as the Zephyr one, the caller serializes the access.
+ * The size must be a power of two, so that the indexes may wrap around. */
+struct ring_buf
+{
+    uint8_t* p_buf;
+    uint32_t size;
+    uint32_t put_idx; //!< Total number of bytes put (wraps around)
+    uint32_t get_idx; //!< Total number of bytes got (wraps around)
+};
+
+#define RING_BUF_DECLARE(name, size8) \
+    static uint8_t  name##_data[size8]; \
+    struct ring_buf name = { .p_buf = name##_data, .size = (size8) }
+
+static inline void
+ring_buf_reset(struct ring_buf* buf)
+{
+    buf->put_idx = 0;
+    buf->get_idx = 0;
+}
+
+static inline uint32_t
+ring_buf_put(struct ring_buf* buf, const uint8_t* data, uint32_t size)
+{
+    uint32_t len = 0;
+    while ((len < size) && ((buf->put_idx - buf->get_idx) < buf->size))
+    {
+        buf->p_buf[buf->put_idx % buf->size] = data[len];
+        buf->put_idx += 1;
+        len += 1;
+    }
+    return len;
+}
+
+static inline uint32_t
+ring_buf_get(struct ring_buf* buf, uint8_t* data, uint32_t size)
+{
+    uint32_t len = 0;
+    while ((len < size) && (buf->get_idx != buf->put_idx))
+    {
+        data[len] = buf->p_buf[buf->get_idx % buf->size];
+        buf->get_idx += 1;
+        len += 1;
+    }
+    return len;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // HOST_SHIM_ZEPHYR_SYS_RING_BUFFER_H
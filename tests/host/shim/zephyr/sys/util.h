@@ -0,0 +1,18 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_SYS_UTIL_H
+#define HOST_SHIM_ZEPHYR_SYS_UTIL_H
+
+#define BIT(n) (1UL << (n))
+
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+
+#define DIV_ROUND_UP(n, d) (((n) + (d) - 1U) / (d))
+#define ROUND_UP(x, align) (DIV_ROUND_UP(x, align) * (align))
+
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+#endif // HOST_SHIM_ZEPHYR_SYS_UTIL_H
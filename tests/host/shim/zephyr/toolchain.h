@@ -0,0 +1,16 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef HOST_SHIM_ZEPHYR_TOOLCHAIN_H
+#define HOST_SHIM_ZEPHYR_TOOLCHAIN_H
+
+#define __aligned(x) __attribute__((aligned(x)))
+#define __NO_RETURN  __attribute__((noreturn))
+
+#define ARG_UNUSED(x) (void)(x)
+
+/* Sections of the firmware linker script do not exist on the host. */
+#define Z_GENERIC_SECTION(segment)
+
+#endif // HOST_SHIM_ZEPHYR_TOOLCHAIN_H
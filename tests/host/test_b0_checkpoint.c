@@ -0,0 +1,127 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <string.h>
+#include "test_util.h"
+#include "../../src/b0_retained.c"
+#include "../../src/b0_checkpoint.c" // NOSONAR: the state of the module is reset between test cases
+
+#define TEST_FA_ID_S0 (3U)
+#define TEST_FA_ID_S1 (4U)
+
+static void
+test_setup(void)
+{
+    host_shim_k_reset();
+    memset(g_host_shim_shared_sram, 0, sizeof(g_host_shim_shared_sram));
+    b0_retained_init();
+    g_checkpoint_is_active = false;
+    g_checkpoint_is_logged = false;
+}
+
+/* Simulate a reset which keeps the RAM: the static state of B0 is lost, the retained block is kept. */
+static void
+test_reset(void)
+{
+    g_checkpoint_is_active = false;
+    g_checkpoint_is_logged = false;
+    b0_retained_init();
+}
+
+static void
+test_not_recorded_outside_of_recovery(void)
+{
+    test_setup();
+    b0_checkpoint_update(B0_CHECKPOINT_OP_ERASE, TEST_FA_ID_S0, 0x1000U);
+    TEST_CHECK(B0_CHECKPOINT_MAGIC != b0_retained_get()->checkpoint.magic);
+    TEST_CHECK(!b0_checkpoint_is_interrupted());
+}
+
+static void
+test_completed_recovery(void)
+{
+    test_setup();
+    TEST_CHECK(B0_CHECKPOINT_FA_ID_NONE == b0_checkpoint_begin());
+    b0_checkpoint_update(B0_CHECKPOINT_OP_WRITE, TEST_FA_ID_S0, 0x1000U);
+    b0_checkpoint_update(B0_CHECKPOINT_OP_DONE, B0_CHECKPOINT_FA_ID_NONE, 0);
+    const b0_checkpoint_t* const p_checkpoint = &b0_retained_get()->checkpoint;
+    TEST_CHECK(B0_CHECKPOINT_OP_DONE == p_checkpoint->op);
+    TEST_CHECK(2U == p_checkpoint->seq_num);
+
+    // The self-test after the recovery does not overwrite the record
+    b0_checkpoint_update(B0_CHECKPOINT_OP_VERIFY, TEST_FA_ID_S1, 0x2000U);
+    TEST_CHECK(B0_CHECKPOINT_OP_DONE == p_checkpoint->op);
+    TEST_CHECK(!b0_checkpoint_is_interrupted());
+}
+
+static void
+test_failed_recovery_is_not_resumed(void)
+{
+    test_setup();
+    (void)b0_checkpoint_begin();
+    b0_checkpoint_update(B0_CHECKPOINT_OP_VERIFY, TEST_FA_ID_S0, 0x1000U);
+    b0_checkpoint_update(B0_CHECKPOINT_OP_FAILED, B0_CHECKPOINT_FA_ID_NONE, 0);
+    test_reset();
+    TEST_CHECK(!b0_checkpoint_is_interrupted());
+}
+
+static void
+test_interrupted_recovery_is_resumed(void)
+{
+    test_setup();
+    (void)b0_checkpoint_begin();
+    b0_checkpoint_update(B0_CHECKPOINT_OP_WRITE, TEST_FA_ID_S1, 0x3000U);
+    test_reset();
+
+    const b0_checkpoint_t* const p_checkpoint = &b0_retained_get()->checkpoint;
+    for (uint32_t i = 0; i < B0_CHECKPOINT_MAX_RESUMES; ++i)
+    {
+        TEST_CHECK(b0_checkpoint_is_interrupted());
+        const uint32_t seq_num = p_checkpoint->seq_num;
+        TEST_CHECK(TEST_FA_ID_S1 == b0_checkpoint_begin());
+        TEST_CHECK((i + 1) == p_checkpoint->num_resumes);
+        TEST_CHECK(TEST_FA_ID_S1 == p_checkpoint->resume_fa_id);
+        TEST_CHECK(B0_CHECKPOINT_OP_WRITE == p_checkpoint->op);
+        TEST_CHECK(0x3000U == p_checkpoint->offset);
+        TEST_CHECK((seq_num + 1) == p_checkpoint->seq_num);
+        test_reset();
+    }
+    // B0 gives up and boots normally, the record is kept for the application
+    TEST_CHECK(!b0_checkpoint_is_interrupted());
+    TEST_CHECK(B0_CHECKPOINT_OP_WRITE == p_checkpoint->op);
+
+    // The recovery started with the button continues the record
+    TEST_CHECK(TEST_FA_ID_S1 == b0_checkpoint_begin());
+    b0_checkpoint_update(B0_CHECKPOINT_OP_DONE, B0_CHECKPOINT_FA_ID_NONE, 0);
+    TEST_CHECK((B0_CHECKPOINT_MAX_RESUMES + 1) == p_checkpoint->num_resumes);
+
+    // The next recovery starts a fresh record
+    TEST_CHECK(B0_CHECKPOINT_FA_ID_NONE == b0_checkpoint_begin());
+    TEST_CHECK(0 == p_checkpoint->num_resumes);
+    TEST_CHECK(0 == p_checkpoint->seq_num);
+}
+
+static void
+test_power_loss_clears_record(void)
+{
+    test_setup();
+    (void)b0_checkpoint_begin();
+    b0_checkpoint_update(B0_CHECKPOINT_OP_ERASE, TEST_FA_ID_S0, 0x1000U);
+    memset(g_host_shim_shared_sram, 0xA5, sizeof(g_host_shim_shared_sram));
+    test_reset();
+    TEST_CHECK(!b0_checkpoint_is_interrupted());
+}
+
+int
+main(void)
+{
+    TEST_RUN(test_not_recorded_outside_of_recovery);
+    TEST_RUN(test_completed_recovery);
+    TEST_RUN(test_failed_recovery_is_not_resumed);
+    TEST_RUN(test_interrupted_recovery_is_resumed);
+    TEST_RUN(test_power_loss_clears_record);
+    return EXIT_SUCCESS;
+}
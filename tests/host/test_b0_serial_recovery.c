@@ -0,0 +1,486 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#define _GNU_SOURCE // posix_openpt(), ptsname_r()
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <pthread.h>
+#include <termios.h>
+#include <unistd.h>
+#include <sys/wait.h>
+#include "test_util.h"
+#include "../../src/b0_serial_recovery.c" // NOSONAR: the state of the module is checked by the test cases
+
+/* The device side is the serial recovery of B0 on the master side of a pseudo-terminal (the emulated UART),
+ * the host side is scripts/b0_serial_recovery.py or a minimal host built on b0_serial_proto.c on the slave side.
+ * Usage: test_b0_serial_recovery [<python3> <scripts/b0_serial_recovery.py>] */
+
+#define TEST_IMG_MAGIC         (0x474D4954U) // "TIMG"
+#define TEST_IMG_HDR_SIZE      (12U)
+#define TEST_IMG_SIGNED_OK     (0x01U)
+#define TEST_IMG_SIGNED_BAD    (0x02U)
+#define TEST_FLASH_GARBAGE     (0x5AU)
+#define TEST_HOST_RSP_TIMEOUT  (2000)  // ms
+#define TEST_HOST_DONE_STEP_MS (1000U) // uptime advance per step after the host has finished
+#define TEST_MAX_SCRIPT_ARGS   (16U)
+#define TEST_MAX_IMAGE_FILES   (8U)
+
+typedef enum test_host_e
+{
+    TEST_HOST_SCRIPT,
+    TEST_HOST_PROTO,
+} test_host_e;
+
+static const char* g_p_test_python;
+static const char* g_p_test_script;
+static char        g_test_dir[] = "/tmp/test_b0_serial_recovery_XXXXXX";
+static int         g_test_pty_master_fd;
+static int         g_test_pty_slave_fd;
+static char        g_test_pty_slave_name[64];
+static uint32_t    g_test_num_validations;
+static int32_t     g_test_power_off_lock_cnt;
+
+static const char* g_p_test_script_args[TEST_MAX_SCRIPT_ARGS];
+static char        g_test_image_paths[TEST_MAX_IMAGE_FILES][128];
+static uint32_t    g_test_num_image_files;
+static int         g_test_script_exit_code;
+static bool        g_test_is_device_done;
+
+int
+btldr_img_op_erase_page(const struct flash_area* const p_fa, const off_t page_offset, const size_t page_size)
+{
+    return flash_area_erase(p_fa, page_offset, page_size);
+}
+
+void
+btldr_img_op_on_slice(const btldr_img_op_stage_e stage, const struct flash_area* const p_fa, const off_t offset)
+{
+    (void)stage;
+    (void)p_fa;
+    (void)offset;
+}
+
+bool
+btldr_img_op_check_fw_info(const fa_id_t fa_id, const char* const p_fa_name)
+{
+    (void)p_fa_name;
+    const struct flash_area* p_fa   = NULL;
+    uint8_t                  hdr[4] = { 0 };
+    TEST_CHECK(0 == flash_area_open(fa_id, &p_fa));
+    TEST_CHECK(0 == flash_area_read(p_fa, 0, hdr, sizeof(hdr)));
+    return TEST_IMG_MAGIC == b0_serial_proto_get_u32(hdr);
+}
+
+/* The header of the test images is the magic, the "signature" flag and the address the image is linked for. */
+const struct fw_info*
+fw_info_find(uint32_t firmware_address)
+{
+    static struct fw_info info;
+
+    const uint8_t* const p_img = &g_host_shim_flash[firmware_address];
+    if (TEST_IMG_MAGIC != b0_serial_proto_get_u32(p_img))
+    {
+        return NULL;
+    }
+    memset(&info, 0, sizeof(info));
+    info.address = b0_serial_proto_get_u32(&p_img[8]);
+    return &info;
+}
+
+/* Like validate_firmware() of NCS, the image must be linked for the destination address. */
+bool
+bl_validate_firmware(uint32_t fw_dst_address, uint32_t fw_src_address)
+{
+    g_test_num_validations += 1;
+    TEST_CHECK(fw_dst_address == fw_src_address);
+    const uint32_t       slot_addr = (fw_src_address >= PM_S1_ADDRESS) ? PM_S1_ADDRESS : PM_S0_ADDRESS;
+    const uint8_t* const p_img     = &g_host_shim_flash[slot_addr];
+    return (TEST_IMG_MAGIC == b0_serial_proto_get_u32(p_img)) && (TEST_IMG_SIGNED_OK == p_img[4])
+           && (fw_dst_address == b0_serial_proto_get_u32(&p_img[8]));
+}
+
+void
+b0_supercap_lock_power_off(void)
+{
+    g_test_power_off_lock_cnt += 1;
+}
+
+void
+b0_supercap_unlock_power_off(void)
+{
+    g_test_power_off_lock_cnt -= 1;
+}
+
+void
+b0_supercap_on_page_boundary(void)
+{
+}
+
+static void
+test_setup(void)
+{
+    memset(g_host_shim_flash, 0xFF, sizeof(g_host_shim_flash));
+    g_test_num_validations    = 0;
+    g_test_power_off_lock_cnt = 0;
+    g_test_script_exit_code   = -1;
+    g_test_is_device_done     = false;
+    TEST_CHECK(0 == tcflush(g_test_pty_slave_fd, TCIOFLUSH));
+}
+
+static void
+test_fill_flash(const fa_id_t fa_id, const uint8_t value)
+{
+    const struct flash_area* p_fa = NULL;
+    TEST_CHECK(0 == flash_area_open(fa_id, &p_fa));
+    memset(&g_host_shim_flash[p_fa->fa_off], value, p_fa->fa_size);
+}
+
+static void
+test_make_image(
+    uint8_t* const p_img,
+    const uint32_t size,
+    const uint8_t  signature,
+    const uint32_t link_addr,
+    const uint32_t seed)
+{
+    b0_serial_proto_put_u32(&p_img[0], TEST_IMG_MAGIC);
+    b0_serial_proto_put_u32(&p_img[4], signature);
+    b0_serial_proto_put_u32(&p_img[8], link_addr);
+    uint32_t state = seed;
+    for (uint32_t i = TEST_IMG_HDR_SIZE; i < size; ++i)
+    {
+        state    = (state * 1103515245U) + 12345U;
+        p_img[i] = (uint8_t)(state >> 16U);
+    }
+}
+
+static const char*
+test_write_image(const char* const p_name, const uint8_t* const p_img, const uint32_t size)
+{
+    TEST_CHECK(g_test_num_image_files < TEST_MAX_IMAGE_FILES);
+    char* const p_path = g_test_image_paths[g_test_num_image_files++];
+    (void)snprintf(p_path, sizeof(g_test_image_paths[0]), "%s/%s.bin", g_test_dir, p_name);
+    FILE* const p_file = fopen(p_path, "wb");
+    TEST_CHECK(NULL != p_file);
+    TEST_CHECK(size == fwrite(p_img, 1, size, p_file));
+    TEST_CHECK(0 == fclose(p_file));
+    return p_path;
+}
+
+/**
+ * @brief Check that the slot contains the image followed by the erased flash.
+ */
+static bool
+test_is_slot_written(const fa_id_t fa_id, const uint8_t* const p_img, const uint32_t size)
+{
+    const struct flash_area* p_fa = NULL;
+    TEST_CHECK(0 == flash_area_open(fa_id, &p_fa));
+    const uint8_t* const p_slot = &g_host_shim_flash[p_fa->fa_off];
+    if (0 != memcmp(p_slot, p_img, size))
+    {
+        return false;
+    }
+    for (uint32_t i = size; i < p_fa->fa_size; ++i)
+    {
+        if (0xFFU != p_slot[i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool
+test_is_slot_filled(const fa_id_t fa_id, const uint8_t value)
+{
+    const struct flash_area* p_fa = NULL;
+    TEST_CHECK(0 == flash_area_open(fa_id, &p_fa));
+    for (uint32_t i = 0; i < p_fa->fa_size; ++i)
+    {
+        if (value != g_host_shim_flash[p_fa->fa_off + i])
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void
+test_host_send(const uint8_t type, const uint16_t seq, const uint8_t* const p_payload, const uint16_t len)
+{
+    uint8_t      buf[B0_SERIAL_PROTO_FRAME_MAX_SIZE];
+    const size_t frame_len = b0_serial_proto_encode(buf, type, seq, p_payload, len);
+    TEST_CHECK((ssize_t)frame_len == write(g_test_pty_slave_fd, buf, frame_len));
+}
+
+/**
+ * @brief Receive the response to the request with the sequence number.
+ * @return the response frame or NULL on timeout.
+ */
+static const b0_serial_proto_frame_t*
+test_host_recv(b0_serial_proto_parser_t* const p_parser, const uint16_t seq)
+{
+    struct pollfd pfd = { .fd = g_test_pty_slave_fd, .events = POLLIN };
+    while (poll(&pfd, 1, TEST_HOST_RSP_TIMEOUT) > 0)
+    {
+        uint8_t byte = 0;
+        TEST_CHECK(1 == read(g_test_pty_slave_fd, &byte, 1));
+        if ((B0_SERIAL_PROTO_PARSER_RES_FRAME == b0_serial_proto_parser_feed(p_parser, byte))
+            && (seq == p_parser->frame.seq))
+        {
+            return &p_parser->frame;
+        }
+    }
+    return NULL;
+}
+
+static void
+test_host_expect_nak(
+    b0_serial_proto_parser_t* const p_parser,
+    const uint8_t                   type,
+    const uint16_t                  seq,
+    const uint8_t* const            p_payload,
+    const uint16_t                  len,
+    const b0_serial_proto_err_e     err)
+{
+    test_host_send(type, seq, p_payload, len);
+    const b0_serial_proto_frame_t* const p_rsp = test_host_recv(p_parser, seq);
+    TEST_CHECK(NULL != p_rsp);
+    TEST_CHECK(B0_SERIAL_PROTO_TYPE_NAK == p_rsp->type);
+    TEST_CHECK(err == p_rsp->payload[0]);
+}
+
+/**
+ * @brief Try to write the provision partition (slot 0) and to finish without valid images.
+ */
+static void
+test_host_proto_run(void)
+{
+    b0_serial_proto_parser_t parser;
+    b0_serial_proto_parser_reset(&parser);
+
+    test_host_send(B0_SERIAL_PROTO_TYPE_HELLO, 1, NULL, 0);
+    const b0_serial_proto_frame_t* const p_rsp = test_host_recv(&parser, 1);
+    TEST_CHECK(NULL != p_rsp);
+    TEST_CHECK(B0_SERIAL_PROTO_TYPE_HELLO_RSP == p_rsp->type);
+    TEST_CHECK(B0_SERIAL_PROTO_VERSION == p_rsp->payload[0]);
+
+    uint8_t begin[9] = { 0 };
+    b0_serial_proto_put_u32(&begin[1], B0_SERIAL_PROTO_CHUNK_SIZE);
+    begin[0] = 0; // former provision slot
+    test_host_expect_nak(&parser, B0_SERIAL_PROTO_TYPE_BEGIN, 2, begin, sizeof(begin), B0_SERIAL_PROTO_ERR_PARAM);
+    begin[0] = B0_SERIAL_PROTO_NUM_SLOTS;
+    test_host_expect_nak(&parser, B0_SERIAL_PROTO_TYPE_BEGIN, 3, begin, sizeof(begin), B0_SERIAL_PROTO_ERR_PARAM);
+    test_host_expect_nak(&parser, B0_SERIAL_PROTO_TYPE_DATA, 0, begin, sizeof(begin), B0_SERIAL_PROTO_ERR_STATE);
+    test_host_expect_nak(&parser, B0_SERIAL_PROTO_TYPE_FINISH, 4, NULL, 0, B0_SERIAL_PROTO_ERR_VERIFY);
+}
+
+static void
+test_host_script_run(void)
+{
+    const pid_t pid = fork();
+    TEST_CHECK(pid >= 0);
+    if (0 == pid)
+    {
+        (void)execv(g_p_test_python, (char* const*)g_p_test_script_args);
+        _exit(EXIT_FAILURE);
+    }
+    int status = 0;
+    TEST_CHECK(pid == waitpid(pid, &status, 0));
+    g_test_script_exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+/* When the host has finished, the uptime is advanced until the device gives up waiting for the next frame. */
+static void*
+test_host_thread(void* p_arg)
+{
+    if (TEST_HOST_SCRIPT == *(const test_host_e*)p_arg)
+    {
+        test_host_script_run();
+    }
+    else
+    {
+        test_host_proto_run();
+    }
+    while (!__atomic_load_n(&g_test_is_device_done, __ATOMIC_SEQ_CST))
+    {
+        host_shim_k_uptime_advance(TEST_HOST_DONE_STEP_MS);
+        (void)usleep(1000);
+    }
+    return NULL;
+}
+
+static bool
+test_run_session(test_host_e host)
+{
+    pthread_t thread;
+    TEST_CHECK(0 == pthread_create(&thread, NULL, &test_host_thread, &host));
+    const bool is_finished = b0_serial_recovery_run();
+    __atomic_store_n(&g_test_is_device_done, true, __ATOMIC_SEQ_CST);
+    TEST_CHECK(0 == pthread_join(thread, NULL));
+    TEST_CHECK(0 == g_test_power_off_lock_cnt);
+    return is_finished;
+}
+
+static void
+test_set_script_args(const char* const p_image0, const char* const p_image1)
+{
+    uint32_t idx                = 0;
+    g_p_test_script_args[idx++] = g_p_test_python;
+    g_p_test_script_args[idx++] = g_p_test_script;
+    g_p_test_script_args[idx++] = g_test_pty_slave_name;
+    g_p_test_script_args[idx++] = "--wait";
+    g_p_test_script_args[idx++] = "5";
+    g_p_test_script_args[idx++] = "--image";
+    g_p_test_script_args[idx++] = p_image0;
+    if (NULL != p_image1)
+    {
+        g_p_test_script_args[idx++] = "--image";
+        g_p_test_script_args[idx++] = p_image1;
+    }
+    g_p_test_script_args[idx] = NULL;
+}
+
+static void
+test_provision_slot_rejected(void)
+{
+    test_setup();
+    test_fill_flash(FIXED_PARTITION_ID(s0), TEST_FLASH_GARBAGE);
+    TEST_CHECK(!test_run_session(TEST_HOST_PROTO));
+    TEST_CHECK(0 == g_session.written_slots_mask);
+    TEST_CHECK(test_is_slot_filled(FIXED_PARTITION_ID(s0), TEST_FLASH_GARBAGE));
+    TEST_CHECK(test_is_slot_filled(FIXED_PARTITION_ID(s1), 0xFFU));
+}
+
+static void
+test_script_valid_images(void)
+{
+    static uint8_t s0_img[9000];
+    static uint8_t app_img[20000];
+    char           arg0[160];
+    char           arg1[160];
+    test_setup();
+    test_fill_flash(FIXED_PARTITION_ID(s0), TEST_FLASH_GARBAGE);
+    // fw_info of s0 follows the MCUboot header in s0_pad
+    test_make_image(s0_img, sizeof(s0_img), TEST_IMG_SIGNED_OK, PM_S0_ADDRESS + FW_INFO_OFFSET1, 1);
+    test_make_image(app_img, sizeof(app_img), TEST_IMG_SIGNED_BAD, 0, 2); // validated by MCUboot, not by B0
+    (void)snprintf(arg0, sizeof(arg0), "s0=%s", test_write_image("s0", s0_img, sizeof(s0_img)));
+    (void)snprintf(arg1, sizeof(arg1), "mcuboot_primary=%s", test_write_image("app", app_img, sizeof(app_img)));
+    test_set_script_args(arg0, arg1);
+
+    TEST_CHECK(test_run_session(TEST_HOST_SCRIPT));
+    TEST_CHECK(0 == g_test_script_exit_code);
+    TEST_CHECK(g_test_num_validations >= 1);
+    TEST_CHECK(test_is_slot_written(FIXED_PARTITION_ID(s0), s0_img, sizeof(s0_img)));
+    TEST_CHECK(test_is_slot_written(FIXED_PARTITION_ID(mcuboot_primary), app_img, sizeof(app_img)));
+    TEST_CHECK(test_is_slot_filled(FIXED_PARTITION_ID(s1), 0xFFU));
+}
+
+static void
+test_script_bad_signature(void)
+{
+    static uint8_t s0_img[5000];
+    static uint8_t s1_img[5000];
+    char           arg0[160];
+    test_setup();
+    // s1 contains a valid image, but the written s0 must pass the validation by itself
+    test_make_image(s1_img, sizeof(s1_img), TEST_IMG_SIGNED_OK, PM_S1_ADDRESS, 3);
+    memcpy(&g_host_shim_flash[PM_S1_ADDRESS], s1_img, sizeof(s1_img));
+    test_make_image(s0_img, sizeof(s0_img), TEST_IMG_SIGNED_BAD, PM_S0_ADDRESS, 4);
+    (void)snprintf(arg0, sizeof(arg0), "s0=%s", test_write_image("s0_bad", s0_img, sizeof(s0_img)));
+    test_set_script_args(arg0, NULL);
+
+    TEST_CHECK(!test_run_session(TEST_HOST_SCRIPT));
+    TEST_CHECK(0 != g_test_script_exit_code);
+    TEST_CHECK(1 == g_test_num_validations);
+    TEST_CHECK(!g_session.is_finished);
+}
+
+static void
+test_script_image_linked_for_other_slot(void)
+{
+    static uint8_t s1_img[5000];
+    char           arg0[160];
+    test_setup();
+    // The s0 variant can't boot from s1
+    test_make_image(s1_img, sizeof(s1_img), TEST_IMG_SIGNED_OK, PM_S0_ADDRESS, 5);
+    (void)snprintf(arg0, sizeof(arg0), "s1=%s", test_write_image("s1_s0_variant", s1_img, sizeof(s1_img)));
+    test_set_script_args(arg0, NULL);
+
+    TEST_CHECK(!test_run_session(TEST_HOST_SCRIPT));
+    TEST_CHECK(0 != g_test_script_exit_code);
+    TEST_CHECK(0 == g_test_num_validations);
+    TEST_CHECK(!g_session.is_finished);
+}
+
+static void
+test_script_provision_slot_unknown(void)
+{
+    char arg0[160];
+    test_setup();
+    (void)snprintf(arg0, sizeof(arg0), "provision=%s/s0.bin", g_test_dir);
+    test_set_script_args(arg0, NULL);
+
+    TEST_CHECK(!test_run_session(TEST_HOST_SCRIPT));
+    TEST_CHECK(0 != g_test_script_exit_code);
+    TEST_CHECK(!g_session.is_connected);
+}
+
+static void
+test_open_pty(void)
+{
+    g_test_pty_master_fd = posix_openpt(O_RDWR | O_NOCTTY);
+    TEST_CHECK(g_test_pty_master_fd >= 0);
+    TEST_CHECK(0 == grantpt(g_test_pty_master_fd));
+    TEST_CHECK(0 == unlockpt(g_test_pty_master_fd));
+    TEST_CHECK(0 == ptsname_r(g_test_pty_master_fd, g_test_pty_slave_name, sizeof(g_test_pty_slave_name)));
+
+    // The slave is kept open, so that the master does not see a hang-up between the sessions
+    g_test_pty_slave_fd = open(g_test_pty_slave_name, O_RDWR | O_NOCTTY);
+    TEST_CHECK(g_test_pty_slave_fd >= 0);
+    struct termios tio;
+    TEST_CHECK(0 == tcgetattr(g_test_pty_slave_fd, &tio));
+    cfmakeraw(&tio);
+    TEST_CHECK(0 == tcsetattr(g_test_pty_slave_fd, TCSANOW, &tio));
+}
+
+int
+main(int argc, char** argv)
+{
+    (void)setvbuf(stdout, NULL, _IONBF, 0);
+    TEST_CHECK(NULL != mkdtemp(g_test_dir));
+    test_open_pty();
+    host_shim_uart_emul_attach(g_test_pty_master_fd);
+
+    TEST_RUN(test_provision_slot_rejected);
+    if (argc >= 3)
+    {
+        g_p_test_python = argv[1];
+        g_p_test_script = argv[2];
+        TEST_RUN(test_script_valid_images);
+        TEST_RUN(test_script_bad_signature);
+        TEST_RUN(test_script_image_linked_for_other_slot);
+        TEST_RUN(test_script_provision_slot_unknown);
+    }
+    else
+    {
+        (void)printf("Skip the cases with scripts/b0_serial_recovery.py, Python 3 with pyserial is not available\n");
+    }
+
+    host_shim_uart_emul_detach();
+    (void)close(g_test_pty_slave_fd);
+    (void)close(g_test_pty_master_fd);
+    for (uint32_t i = 0; i < g_test_num_image_files; ++i)
+    {
+        (void)unlink(g_test_image_paths[i]);
+    }
+    (void)rmdir(g_test_dir);
+    return EXIT_SUCCESS;
+}
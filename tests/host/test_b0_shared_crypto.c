@@ -0,0 +1,162 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include "test_util.h"
+#include "../../src/b0_shared_crypto.c" // NOSONAR: the exported API structure is defined there
+
+#define TEST_IMG_SIZE (100U * 1024U + 123U)
+
+static uint8_t  g_test_img[TEST_IMG_SIZE];
+static uint8_t  g_test_provisioned_key_hash[CONFIG_SB_PUBLIC_KEY_HASH_LEN];
+static uint8_t  g_test_validated_hash[B0_SHARED_CRYPTO_DIGEST_SIZE];
+static uint32_t g_test_num_validations;
+
+uint32_t
+num_public_keys_read(void)
+{
+    return 1;
+}
+
+int
+public_key_data_read(uint32_t key_idx, uint8_t* p_buf)
+{
+    (void)key_idx;
+    memcpy(p_buf, g_test_provisioned_key_hash, sizeof(g_test_provisioned_key_hash));
+    return (int)sizeof(g_test_provisioned_key_hash);
+}
+
+int
+bl_secp256r1_validate(const uint8_t* p_hash, uint32_t hash_len, const uint8_t* p_public_key, const uint8_t* p_signature)
+{
+    (void)p_public_key;
+    g_test_num_validations += 1;
+    TEST_CHECK(sizeof(g_test_validated_hash) == hash_len);
+    memcpy(g_test_validated_hash, p_hash, hash_len);
+    return (0xA5U == p_signature[0]) ? 0 : -EINVAL;
+}
+
+static void
+test_calc_digest_one_shot(const uint8_t* const p_data, const uint32_t len, uint8_t* const p_digest)
+{
+    bl_sha256_ctx_t ctx;
+    TEST_CHECK(0 == bl_sha256_init(&ctx));
+    TEST_CHECK(0 == bl_sha256_update(&ctx, p_data, len));
+    TEST_CHECK(0 == bl_sha256_finalize(&ctx, p_digest));
+}
+
+/* Pass the image through the chunk window like MCUboot does, with chunks of at most max_chunk_len bytes. */
+static void
+test_calc_digest_chunked(const uint32_t max_chunk_len, uint8_t* const p_digest)
+{
+    const struct b0_shared_crypto_ext_api* const p_api = &b0_shared_crypto_ext_api.ext_api;
+
+    TEST_CHECK(0 == p_api->hash_init());
+    uint32_t offset = 0;
+    while (offset < TEST_IMG_SIZE)
+    {
+        const uint32_t len = ((TEST_IMG_SIZE - offset) < max_chunk_len) ? (TEST_IMG_SIZE - offset) : max_chunk_len;
+        memcpy(p_api->get_chunk_buf(), &g_test_img[offset], len);
+        TEST_CHECK(0 == p_api->hash_update(len));
+        offset += len;
+    }
+    TEST_CHECK(0 == p_api->hash_finalize(p_digest));
+}
+
+static void
+test_sha256_shim(void)
+{
+    static const uint8_t exp_digest_abc[B0_SHARED_CRYPTO_DIGEST_SIZE] = {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad,
+    };
+    uint8_t digest[B0_SHARED_CRYPTO_DIGEST_SIZE];
+    test_calc_digest_one_shot((const uint8_t*)"abc", 3, digest);
+    TEST_CHECK(0 == memcmp(exp_digest_abc, digest, sizeof(digest)));
+}
+
+static void
+test_ext_api_header(void)
+{
+    TEST_CHECK(CONFIG_B0_SHARED_CRYPTO_EXT_API_ID == b0_shared_crypto_ext_api.header.ext_api_id);
+    TEST_CHECK(B0_SHARED_CRYPTO_EXT_API_VERSION == b0_shared_crypto_ext_api.header.ext_api_version);
+}
+
+static void
+test_chunked_digest_matches_one_shot(void)
+{
+    static const uint32_t chunk_lens[] = { B0_SHARED_CRYPTO_CHUNK_SIZE, B0_SHARED_CRYPTO_CHUNK_SIZE - 1U, 1000U, 63U };
+
+    uint8_t exp_digest[B0_SHARED_CRYPTO_DIGEST_SIZE];
+    test_calc_digest_one_shot(g_test_img, TEST_IMG_SIZE, exp_digest);
+    for (uint32_t i = 0; i < (sizeof(chunk_lens) / sizeof(chunk_lens[0])); ++i)
+    {
+        uint8_t digest[B0_SHARED_CRYPTO_DIGEST_SIZE];
+        test_calc_digest_chunked(chunk_lens[i], digest);
+        TEST_CHECK(0 == memcmp(exp_digest, digest, sizeof(digest)));
+    }
+}
+
+static void
+test_hash_update_rejects_oversized_chunk(void)
+{
+    const struct b0_shared_crypto_ext_api* const p_api = &b0_shared_crypto_ext_api.ext_api;
+
+    TEST_CHECK(0 == p_api->hash_init());
+    TEST_CHECK(-EINVAL == p_api->hash_update(B0_SHARED_CRYPTO_CHUNK_SIZE + 1U));
+}
+
+static void
+test_verify(void)
+{
+    const struct b0_shared_crypto_ext_api* const p_api = &b0_shared_crypto_ext_api.ext_api;
+
+    struct fw_validation_info val_info = { 0 };
+    memset(val_info.public_key, 0x11, sizeof(val_info.public_key));
+    val_info.signature[0] = 0xA5U;
+
+    uint8_t digest[B0_SHARED_CRYPTO_DIGEST_SIZE];
+    test_calc_digest_chunked(B0_SHARED_CRYPTO_CHUNK_SIZE, digest);
+
+    TEST_CHECK(-EBADMSG == p_api->verify(digest, &val_info));
+
+    memcpy(val_info.hash, digest, sizeof(digest));
+    memset(g_test_provisioned_key_hash, 0, sizeof(g_test_provisioned_key_hash));
+    TEST_CHECK(-EPERM == p_api->verify(digest, &val_info));
+    TEST_CHECK(0 == g_test_num_validations);
+
+    uint8_t key_hash[B0_SHARED_CRYPTO_DIGEST_SIZE];
+    test_calc_digest_one_shot(val_info.public_key, sizeof(val_info.public_key), key_hash);
+    memcpy(g_test_provisioned_key_hash, key_hash, sizeof(g_test_provisioned_key_hash));
+    TEST_CHECK(0 == p_api->verify(digest, &val_info));
+    TEST_CHECK(1 == g_test_num_validations);
+
+    /* The signature is checked over the digest of the firmware digest. */
+    uint8_t digest2[B0_SHARED_CRYPTO_DIGEST_SIZE];
+    test_calc_digest_one_shot(digest, sizeof(digest), digest2);
+    TEST_CHECK(0 == memcmp(digest2, g_test_validated_hash, sizeof(digest2)));
+
+    val_info.signature[0] = 0x00U;
+    TEST_CHECK(0 != p_api->verify(digest, &val_info));
+}
+
+int
+main(void)
+{
+    uint32_t seed = 1U;
+    for (uint32_t i = 0; i < TEST_IMG_SIZE; ++i)
+    {
+        seed          = (seed * 1103515245U) + 12345U;
+        g_test_img[i] = (uint8_t)(seed >> 16);
+    }
+
+    TEST_RUN(test_sha256_shim);
+    TEST_RUN(test_ext_api_header);
+    TEST_RUN(test_chunked_digest_matches_one_shot);
+    TEST_RUN(test_hash_update_rejects_oversized_chunk);
+    TEST_RUN(test_verify);
+    return EXIT_SUCCESS;
+}
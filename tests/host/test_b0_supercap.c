@@ -0,0 +1,171 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <setjmp.h>
+#include <zephyr/drivers/gpio/gpio_emul.h>
+#include "test_util.h"
+#include "../../src/b0_supercap.c" // NOSONAR: the state of the module is reset between test cases
+
+#define TEST_SUPERCAP_PIN        HOST_SHIM_GPIO_PIN(DT_ALIAS(gpio_supercap_active))
+#define TEST_MAIN_POWER_OK       1 // SUPERCAP_ACTIVE is active-low
+#define TEST_MAIN_POWER_FAILED   0
+#define TEST_NVMC_ERASE_SLICE_MS (17U)
+
+static jmp_buf  g_test_poweroff_jmp;
+static uint32_t g_test_num_poweroffs;
+
+__NO_RETURN void
+sys_poweroff(void)
+{
+    g_test_num_poweroffs += 1;
+    longjmp(g_test_poweroff_jmp, 1);
+}
+
+void
+b0_led_deinit(void)
+{
+}
+
+void
+b0_button_deinit(void)
+{
+}
+
+static void
+test_setup(void)
+{
+    host_shim_k_reset();
+    host_shim_gpio_emul_reset();
+    g_is_power_off_locked  = false;
+    g_is_power_off_pending = false;
+    g_test_num_poweroffs   = 0;
+    (void)gpio_emul_input_set(&g_host_shim_gpio_emul_port, TEST_SUPERCAP_PIN, TEST_MAIN_POWER_OK);
+    b0_supercap_init();
+    TEST_CHECK(!b0_supercap_is_active());
+}
+
+/* Call the expression and check whether it has powered off the device. */
+#define TEST_CHECK_POWEROFF(expr, is_poweroff_expected) \
+    do \
+    { \
+        if (0 == setjmp(g_test_poweroff_jmp)) \
+        { \
+            expr; \
+            TEST_CHECK(!(is_poweroff_expected)); \
+        } \
+        else \
+        { \
+            TEST_CHECK(is_poweroff_expected); \
+        } \
+    } while (0)
+
+static void
+test_power_fail_when_unlocked(void)
+{
+    test_setup();
+    TEST_CHECK_POWEROFF(
+        (void)gpio_emul_input_set(&g_host_shim_gpio_emul_port, TEST_SUPERCAP_PIN, TEST_MAIN_POWER_FAILED),
+        true);
+    TEST_CHECK(1 == g_test_num_poweroffs);
+}
+
+static void
+test_power_fail_on_init(void)
+{
+    host_shim_k_reset();
+    host_shim_gpio_emul_reset();
+    g_test_num_poweroffs = 0;
+    (void)gpio_emul_input_set(&g_host_shim_gpio_emul_port, TEST_SUPERCAP_PIN, TEST_MAIN_POWER_FAILED);
+    TEST_CHECK_POWEROFF(b0_supercap_init(), true);
+}
+
+static void
+test_power_fail_finishes_page(void)
+{
+    test_setup();
+    b0_supercap_lock_power_off();
+    TEST_CHECK_POWEROFF(
+        (void)gpio_emul_input_set(&g_host_shim_gpio_emul_port, TEST_SUPERCAP_PIN, TEST_MAIN_POWER_FAILED),
+        false);
+    TEST_CHECK(b0_supercap_is_active());
+
+    /* Slices of the current page fit into the hold-up budget. */
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        host_shim_k_uptime_advance(TEST_NVMC_ERASE_SLICE_MS);
+        TEST_CHECK_POWEROFF(b0_supercap_on_slice(TEST_NVMC_ERASE_SLICE_MS), false);
+    }
+    /* A new page is not started. */
+    host_shim_k_uptime_advance(TEST_NVMC_ERASE_SLICE_MS);
+    TEST_CHECK_POWEROFF(b0_supercap_on_page_boundary(), true);
+    TEST_CHECK(1 == g_test_num_poweroffs);
+}
+
+static void
+test_power_fail_budget_exhausted_between_slices(void)
+{
+    test_setup();
+    b0_supercap_lock_power_off();
+    TEST_CHECK_POWEROFF(
+        (void)gpio_emul_input_set(&g_host_shim_gpio_emul_port, TEST_SUPERCAP_PIN, TEST_MAIN_POWER_FAILED),
+        false);
+
+    host_shim_k_uptime_advance(B0_SUPERCAP_HOLDUP_BUDGET_MS - TEST_NVMC_ERASE_SLICE_MS);
+    TEST_CHECK_POWEROFF(b0_supercap_on_slice(TEST_NVMC_ERASE_SLICE_MS), false);
+    host_shim_k_uptime_advance(1U);
+    TEST_CHECK_POWEROFF(b0_supercap_on_slice(TEST_NVMC_ERASE_SLICE_MS), true);
+}
+
+static void
+test_power_fail_budget_expired_during_slice(void)
+{
+    test_setup();
+    b0_supercap_lock_power_off();
+    TEST_CHECK_POWEROFF(
+        (void)gpio_emul_input_set(&g_host_shim_gpio_emul_port, TEST_SUPERCAP_PIN, TEST_MAIN_POWER_FAILED),
+        false);
+
+    host_shim_k_uptime_advance(B0_SUPERCAP_HOLDUP_BUDGET_MS - 1U);
+    TEST_CHECK(0 == g_test_num_poweroffs);
+    /* The operation in progress has not returned in time, the timer powers off the device. */
+    TEST_CHECK_POWEROFF(host_shim_k_uptime_advance(1U), true);
+}
+
+static void
+test_power_fail_on_unlock(void)
+{
+    test_setup();
+    b0_supercap_lock_power_off();
+    TEST_CHECK_POWEROFF(
+        (void)gpio_emul_input_set(&g_host_shim_gpio_emul_port, TEST_SUPERCAP_PIN, TEST_MAIN_POWER_FAILED),
+        false);
+    TEST_CHECK_POWEROFF(b0_supercap_unlock_power_off(), true);
+}
+
+static void
+test_no_power_fail(void)
+{
+    test_setup();
+    b0_supercap_lock_power_off();
+    host_shim_k_uptime_advance(10U * B0_SUPERCAP_HOLDUP_BUDGET_MS);
+    TEST_CHECK_POWEROFF(b0_supercap_on_slice(TEST_NVMC_ERASE_SLICE_MS), false);
+    TEST_CHECK_POWEROFF(b0_supercap_on_page_boundary(), false);
+    TEST_CHECK_POWEROFF(b0_supercap_unlock_power_off(), false);
+    TEST_CHECK(0 == g_test_num_poweroffs);
+}
+
+int
+main(void)
+{
+    TEST_RUN(test_power_fail_when_unlocked);
+    TEST_RUN(test_power_fail_on_init);
+    TEST_RUN(test_power_fail_finishes_page);
+    TEST_RUN(test_power_fail_budget_exhausted_between_slices);
+    TEST_RUN(test_power_fail_budget_expired_during_slice);
+    TEST_RUN(test_power_fail_on_unlock);
+    TEST_RUN(test_no_power_fail);
+    return EXIT_SUCCESS;
+}
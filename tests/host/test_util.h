@@ -0,0 +1,36 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#if !defined(TEST_UTIL_H)
+#define TEST_UTIL_H
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TEST_CHECK(cond) \
+    do \
+    { \
+        if (!(cond)) \
+        { \
+            (void)fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            exit(EXIT_FAILURE); \
+        } \
+    } while (0)
+
+#define TEST_RUN(test_func) \
+    do \
+    { \
+        (void)printf("Run %s\n", #test_func); \
+        test_func(); \
+    } while (0)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // TEST_UTIL_H
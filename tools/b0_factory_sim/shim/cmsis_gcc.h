@@ -0,0 +1,12 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef SIM_SHIM_CMSIS_GCC_H
+#define SIM_SHIM_CMSIS_GCC_H
+
+#ifndef __NO_RETURN
+#define __NO_RETURN __attribute__((__noreturn__))
+#endif
+
+#endif // SIM_SHIM_CMSIS_GCC_H
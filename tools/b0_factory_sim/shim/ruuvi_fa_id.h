@@ -0,0 +1,13 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef SIM_SHIM_RUUVI_FA_ID_H
+#define SIM_SHIM_RUUVI_FA_ID_H
+
+#include <stdint.h>
+
+/* In the simulator flash area IDs are indexes of partitions in the loaded layout. */
+typedef uint8_t fa_id_t;
+
+#endif // SIM_SHIM_RUUVI_FA_ID_H
@@ -0,0 +1,28 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef SIM_SHIM_ZEPHYR_DRIVERS_FLASH_H
+#define SIM_SHIM_ZEPHYR_DRIVERS_FLASH_H
+
+#include <zephyr/storage/flash_map.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct flash_pages_info
+{
+    off_t    start_offset;
+    size_t   size;
+    uint32_t index;
+};
+
+int
+flash_get_page_info_by_offs(const struct device* dev, off_t offset, struct flash_pages_info* info);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_SHIM_ZEPHYR_DRIVERS_FLASH_H
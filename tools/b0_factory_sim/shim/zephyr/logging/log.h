@@ -0,0 +1,40 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef SIM_SHIM_ZEPHYR_LOGGING_LOG_H
+#define SIM_SHIM_ZEPHYR_LOGGING_LOG_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define LOG_LEVEL_ERR 1
+#define LOG_LEVEL_WRN 2
+#define LOG_LEVEL_INF 3
+#define LOG_LEVEL_DBG 4
+
+#define LOG_MODULE_DECLARE(name, level)  extern int sim_log_module_##name
+#define LOG_MODULE_REGISTER(name, level) int sim_log_module_##name
+
+#define LOG_ERR(...) sim_log(LOG_LEVEL_ERR, __VA_ARGS__)
+#define LOG_WRN(...) sim_log(LOG_LEVEL_WRN, __VA_ARGS__)
+#define LOG_INF(...) sim_log(LOG_LEVEL_INF, __VA_ARGS__)
+#define LOG_DBG(...) sim_log(LOG_LEVEL_DBG, __VA_ARGS__)
+
+#define LOG_HEXDUMP_DBG(p_data, len, p_title) sim_log_hexdump(LOG_LEVEL_DBG, (p_data), (len), (p_title))
+
+/* Format strings of the firmware use %d/%u for size_t and off_t, so format checking is not enabled here. */
+void
+sim_log(const int level, const char* const p_fmt, ...);
+
+void
+sim_log_hexdump(const int level, const void* const p_data, const size_t len, const char* const p_title);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_SHIM_ZEPHYR_LOGGING_LOG_H
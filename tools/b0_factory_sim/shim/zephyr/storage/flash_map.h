@@ -0,0 +1,68 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef SIM_SHIM_ZEPHYR_STORAGE_FLASH_MAP_H
+#define SIM_SHIM_ZEPHYR_STORAGE_FLASH_MAP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <sys/types.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef MIN
+#define MIN(a, b) (((a) < (b)) ? (a) : (b))
+#endif
+#ifndef MAX
+#define MAX(a, b) (((a) > (b)) ? (a) : (b))
+#endif
+
+/* The internal flash of the simulated device is a memory buffer, so its base address is known only at runtime. */
+#define CONFIG_FLASH_BASE_ADDRESS ((uintptr_t)sim_flash_get_int_base())
+
+struct device
+{
+    const char* name;
+    uint32_t    dev_idx;
+};
+
+struct flash_area
+{
+    uint8_t              fa_id;
+    uint8_t              fa_device_id;
+    uint16_t             pad16;
+    off_t                fa_off;
+    size_t               fa_size;
+    const struct device* fa_dev;
+};
+
+const uint8_t*
+sim_flash_get_int_base(void);
+
+int
+flash_area_open(uint8_t id, const struct flash_area** fa);
+
+void
+flash_area_close(const struct flash_area* fa);
+
+int
+flash_area_read(const struct flash_area* fa, off_t off, void* dst, size_t len);
+
+int
+flash_area_write(const struct flash_area* fa, off_t off, const void* src, size_t len);
+
+int
+flash_area_erase(const struct flash_area* fa, off_t off, size_t len);
+
+int
+flash_area_flatten(const struct flash_area* fa, off_t off, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_SHIM_ZEPHYR_STORAGE_FLASH_MAP_H
@@ -0,0 +1,10 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef SIM_SHIM_ZEPHYR_API_H
+#define SIM_SHIM_ZEPHYR_API_H
+
+typedef int zephyr_api_ret_t;
+
+#endif // SIM_SHIM_ZEPHYR_API_H
@@ -0,0 +1,595 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/storage/flash_map.h>
+#include <zephyr/logging/log.h>
+#include "btldr_img_op.h"
+#include "sim_flash.h"
+#include "sim_image.h"
+#include "sim_layout.h"
+#include "sim_shim.h"
+#include "sim_timing.h"
+
+LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
+
+#define SIM_INT_FLASH_SIZE       (1024U * 1024U) // nRF52840
+#define SIM_INT_FLASH_PAGE_SIZE  4096U
+#define SIM_EXT_FLASH_PAGE_SIZE  4096U
+#define SIM_EXT_FLASH_BLOCK_SIZE (64U * 1024U)
+
+#define SIM_MAX_ARGS 32
+
+typedef struct sim_recovery_step_t
+{
+    const char* p_fa_src_name;
+    const char* p_fa_dst_name;
+    bool        has_fw_info;
+} sim_recovery_step_t;
+
+/* The same sequence as in factory_fw_recovery() in src/b0_hook.c */
+static const sim_recovery_step_t g_recovery_steps[] = {
+    { "provision_ext", "provision", false },
+    { "s0_ext", "s0", true },
+    { "s1_ext", "s1", true },
+    { "mcuboot_primary_ext", "mcuboot_primary", true },
+    { "mcuboot_secondary_ext", "mcuboot_secondary", true },
+};
+
+#define SIM_NUM_RECOVERY_STEPS (sizeof(g_recovery_steps) / sizeof(g_recovery_steps[0]))
+#define SIM_EXT_USERSPACE_NAME "ext_flash_userspace"
+
+typedef struct sim_args_t
+{
+    const char*           p_layout;
+    const char*           p_ext;
+    const char*           p_ext_out;
+    const char*           p_int;
+    const char*           p_int_out;
+    const char*           p_out;
+    const char*           parts[SIM_MAX_ARGS];
+    uint32_t              num_parts;
+    const char*           sets[SIM_MAX_ARGS];
+    uint32_t              num_sets;
+    sim_timing_profile_t* profiles[SIM_TIMING_MAX_PROFILES];
+    uint32_t              num_profiles;
+    uint32_t              downshift_steps;
+    bool                  is_no_coalesce;
+} sim_args_t;
+
+static void
+sim_print_usage(const char* const p_prog)
+{
+    printf(
+        "Usage:\n"
+        "  %s pack     --layout <partitions.yml> --out <ext.bin> --part <name>=<file.bin|file.hex> ...\n"
+        "  %s check    --layout <partitions.yml> --ext <ext.bin>\n"
+        "  %s simulate --layout <partitions.yml> --ext <ext.bin> [--int <int.bin|int.hex>]\n"
+        "              [--int-out <file>] [--ext-out <file>] [--profile <name>]... [--set <param>=<value>]...\n"
+        "              [--downshift-steps <n>] [--no-coalesce]\n"
+        "  %s profiles\n"
+        "Options:\n"
+        "  -v, -vv         verbose or debug output\n"
+        "  --no-coalesce   copy the partitions one by one instead of streaming adjacent ones as one run\n",
+        p_prog,
+        p_prog,
+        p_prog,
+        p_prog);
+}
+
+static bool
+sim_parse_args(const int argc, char** const argv, sim_args_t* const p_args)
+{
+    for (int i = 2; i < argc; ++i)
+    {
+        const char* const p_arg   = argv[i];
+        const char* const p_value = ((i + 1) < argc) ? argv[i + 1] : NULL;
+        if (0 == strcmp(p_arg, "-v"))
+        {
+            sim_shim_set_log_level(LOG_LEVEL_INF);
+            continue;
+        }
+        if (0 == strcmp(p_arg, "-vv"))
+        {
+            sim_shim_set_log_level(LOG_LEVEL_DBG);
+            continue;
+        }
+        if (0 == strcmp(p_arg, "--no-coalesce"))
+        {
+            p_args->is_no_coalesce = true;
+            continue;
+        }
+        if (NULL == p_value)
+        {
+            LOG_ERR("Missing value for %s", p_arg);
+            return false;
+        }
+        i += 1;
+        if (0 == strcmp(p_arg, "--layout"))
+        {
+            p_args->p_layout = p_value;
+        }
+        else if (0 == strcmp(p_arg, "--ext"))
+        {
+            p_args->p_ext = p_value;
+        }
+        else if (0 == strcmp(p_arg, "--ext-out"))
+        {
+            p_args->p_ext_out = p_value;
+        }
+        else if (0 == strcmp(p_arg, "--int"))
+        {
+            p_args->p_int = p_value;
+        }
+        else if (0 == strcmp(p_arg, "--int-out"))
+        {
+            p_args->p_int_out = p_value;
+        }
+        else if (0 == strcmp(p_arg, "--out"))
+        {
+            p_args->p_out = p_value;
+        }
+        else if ((0 == strcmp(p_arg, "--part")) && (p_args->num_parts < SIM_MAX_ARGS))
+        {
+            p_args->parts[p_args->num_parts++] = p_value;
+        }
+        else if ((0 == strcmp(p_arg, "--set")) && (p_args->num_sets < SIM_MAX_ARGS))
+        {
+            p_args->sets[p_args->num_sets++] = p_value;
+        }
+        else if ((0 == strcmp(p_arg, "--profile")) && (p_args->num_profiles < SIM_TIMING_MAX_PROFILES))
+        {
+            sim_timing_profile_t* const p_profile = sim_timing_find_profile(p_value);
+            if (NULL == p_profile)
+            {
+                LOG_ERR("Unknown timing profile: %s", p_value);
+                return false;
+            }
+            p_args->profiles[p_args->num_profiles++] = p_profile;
+        }
+        else if (0 == strcmp(p_arg, "--downshift-steps"))
+        {
+            p_args->downshift_steps = (uint32_t)strtoul(p_value, NULL, 0);
+        }
+        else
+        {
+            LOG_ERR("Unknown option: %s", p_arg);
+            return false;
+        }
+    }
+    if (0 == p_args->num_profiles)
+    {
+        for (uint32_t i = 0; i < sim_timing_get_num_profiles(); ++i)
+        {
+            p_args->profiles[p_args->num_profiles++] = sim_timing_get_profile(i);
+        }
+    }
+    for (uint32_t i = 0; i < p_args->num_sets; ++i)
+    {
+        for (uint32_t j = 0; j < p_args->num_profiles; ++j)
+        {
+            if (!sim_timing_set_param(p_args->profiles[j], p_args->sets[i]))
+            {
+                LOG_ERR("Invalid timing parameter: %s", p_args->sets[i]);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+static bool
+sim_load_layout(const sim_args_t* const p_args)
+{
+    if (NULL == p_args->p_layout)
+    {
+        LOG_ERR("--layout is required");
+        return false;
+    }
+    if (!sim_layout_load(p_args->p_layout))
+    {
+        return false;
+    }
+    for (uint32_t i = 0; i < SIM_NUM_RECOVERY_STEPS; ++i)
+    {
+        const sim_recovery_step_t* const p_step = &g_recovery_steps[i];
+        if ((sim_flash_find_partition(p_step->p_fa_src_name) < 0)
+            || (sim_flash_find_partition(p_step->p_fa_dst_name) < 0))
+        {
+            LOG_ERR(
+                "Partition %s or %s is missing in %s",
+                p_step->p_fa_src_name,
+                p_step->p_fa_dst_name,
+                p_args->p_layout);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Allocate a buffer for the flash device and fill it with the content of the file (if given).
+ */
+static uint8_t*
+sim_load_dev(const sim_flash_dev_e dev, const char* const p_path, const size_t min_size, size_t* const p_size)
+{
+    uint8_t* p_file_buf = NULL;
+    size_t   file_size  = 0;
+    if ((NULL != p_path) && !sim_image_load(p_path, 0, &p_file_buf, &file_size))
+    {
+        return NULL;
+    }
+    const size_t size  = MAX(min_size, file_size);
+    uint8_t*     p_buf = malloc(size);
+    if (NULL == p_buf)
+    {
+        free(p_file_buf);
+        return NULL;
+    }
+    memset(p_buf, 0xFF, size);
+    if (NULL != p_file_buf)
+    {
+        memcpy(p_buf, p_file_buf, file_size);
+        free(p_file_buf);
+    }
+    if (SIM_FLASH_DEV_INT == dev)
+    {
+        sim_flash_attach(dev, p_buf, size, SIM_INT_FLASH_PAGE_SIZE, 0);
+    }
+    else
+    {
+        sim_flash_attach(dev, p_buf, size, SIM_EXT_FLASH_PAGE_SIZE, SIM_EXT_FLASH_BLOCK_SIZE);
+    }
+    *p_size = size;
+    return p_buf;
+}
+
+/* The same checks as in check_images_in_ext_flash() in src/b0_hook.c */
+static bool
+sim_check_images_in_ext_flash(void)
+{
+    bool is_ok = true;
+    for (uint32_t i = 0; i < SIM_NUM_RECOVERY_STEPS; ++i)
+    {
+        const sim_recovery_step_t* const p_step = &g_recovery_steps[i];
+        if (!p_step->has_fw_info)
+        {
+            continue;
+        }
+        const fa_id_t fa_id = (fa_id_t)sim_flash_find_partition(p_step->p_fa_src_name);
+        if (btldr_img_op_check_fw_info(fa_id, p_step->p_fa_src_name))
+        {
+            printf("  %-24s fw_info: OK\n", p_step->p_fa_src_name);
+        }
+        else
+        {
+            printf("  %-24s fw_info: NOT FOUND\n", p_step->p_fa_src_name);
+            is_ok = false;
+        }
+    }
+    return is_ok;
+}
+
+static int
+sim_cmd_pack(const sim_args_t* const p_args)
+{
+    if (NULL == p_args->p_out)
+    {
+        LOG_ERR("--out is required");
+        return EXIT_FAILURE;
+    }
+    size_t         ext_size = 0;
+    uint8_t* const p_ext
+        = sim_load_dev(SIM_FLASH_DEV_EXT, NULL, sim_flash_get_layout_end(SIM_FLASH_DEV_EXT), &ext_size);
+    if (NULL == p_ext)
+    {
+        return EXIT_FAILURE;
+    }
+    for (uint32_t i = 0; i < p_args->num_parts; ++i)
+    {
+        char name[SIM_FLASH_NAME_MAX_LEN];
+        const char* const p_eq = strchr(p_args->parts[i], '=');
+        if ((NULL == p_eq) || ((size_t)(p_eq - p_args->parts[i]) >= sizeof(name)))
+        {
+            LOG_ERR("Invalid --part argument: %s", p_args->parts[i]);
+            return EXIT_FAILURE;
+        }
+        (void)snprintf(name, sizeof(name), "%.*s", (int)(p_eq - p_args->parts[i]), p_args->parts[i]);
+        const int fa_id = sim_flash_find_partition(name);
+        if (fa_id < 0)
+        {
+            LOG_ERR("Unknown partition: %s", name);
+            return EXIT_FAILURE;
+        }
+        const struct flash_area* const p_fa = &sim_flash_get_partition((uint8_t)fa_id)->fa;
+        if (SIM_FLASH_DEV_EXT != p_fa->fa_device_id)
+        {
+            LOG_ERR("Partition %s is not in external flash", name);
+            return EXIT_FAILURE;
+        }
+
+        /* Intel HEX files contain addresses of the internal counterpart of the partition (e.g. s0 for s0_ext). */
+        uint32_t     base_addr = SIM_IMAGE_BASE_ADDR_AUTO;
+        const size_t name_len  = strlen(name);
+        if ((name_len > 4) && (0 == strcmp(&name[name_len - 4], "_ext")))
+        {
+            name[name_len - 4]    = '\0';
+            const int int_fa_id = sim_flash_find_partition(name);
+            if (int_fa_id >= 0)
+            {
+                base_addr = (uint32_t)sim_flash_get_partition((uint8_t)int_fa_id)->fa.fa_off;
+            }
+        }
+
+        uint8_t* p_img    = NULL;
+        size_t   img_size = 0;
+        if (!sim_image_load(p_eq + 1, base_addr, &p_img, &img_size))
+        {
+            return EXIT_FAILURE;
+        }
+        if (img_size > p_fa->fa_size)
+        {
+            LOG_ERR("%s (%zu bytes) does not fit into %s (%zu bytes)", p_eq + 1, img_size, name, p_fa->fa_size);
+            free(p_img);
+            return EXIT_FAILURE;
+        }
+        memcpy(&p_ext[p_fa->fa_off], p_img, img_size);
+        free(p_img);
+        printf(
+            "  %-24s 0x%08lx: %s (%zu bytes)\n",
+            sim_flash_get_partition((uint8_t)fa_id)->name,
+            (long)p_fa->fa_off,
+            p_eq + 1,
+            img_size);
+    }
+    printf("Check images:\n");
+    const bool is_ok = sim_check_images_in_ext_flash();
+    if (!sim_image_save(p_args->p_out, p_ext, ext_size))
+    {
+        return EXIT_FAILURE;
+    }
+    printf("Factory bundle: %s (%zu bytes)%s\n", p_args->p_out, ext_size, is_ok ? "" : " - INVALID");
+    return is_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int
+sim_cmd_check(const sim_args_t* const p_args)
+{
+    size_t ext_size = 0;
+    if (NULL == sim_load_dev(SIM_FLASH_DEV_EXT, p_args->p_ext, sim_flash_get_layout_end(SIM_FLASH_DEV_EXT), &ext_size))
+    {
+        return EXIT_FAILURE;
+    }
+    printf("Check images:\n");
+    const bool is_ok = sim_check_images_in_ext_flash();
+    printf("Factory bundle is %s\n", is_ok ? "valid" : "INVALID");
+    return is_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static sim_flash_stat_t
+sim_stat_diff(const sim_flash_stat_t* const p_after, const sim_flash_stat_t* const p_before)
+{
+    const sim_flash_stat_t diff = {
+        .num_read_ops      = p_after->num_read_ops - p_before->num_read_ops,
+        .read_bytes        = p_after->read_bytes - p_before->read_bytes,
+        .num_write_ops     = p_after->num_write_ops - p_before->num_write_ops,
+        .write_bytes       = p_after->write_bytes - p_before->write_bytes,
+        .num_erased_pages  = p_after->num_erased_pages - p_before->num_erased_pages,
+        .num_erased_blocks = p_after->num_erased_blocks - p_before->num_erased_blocks,
+    };
+    return diff;
+}
+
+static void
+sim_print_step(
+    const sim_args_t* const       p_args,
+    const char* const             p_name,
+    const sim_flash_stat_t* const p_before,
+    const uint32_t                num_runs,
+    double* const                 p_total_ms)
+{
+    printf("%-44s", p_name);
+    sim_flash_stat_t diff[SIM_FLASH_DEV_NUM];
+    for (uint32_t dev = 0; dev < SIM_FLASH_DEV_NUM; ++dev)
+    {
+        diff[dev] = sim_stat_diff(sim_flash_get_stat((sim_flash_dev_e)dev), &p_before[dev]);
+    }
+    printf(
+        " %4u %10llu %10llu %6llu %6llu",
+        (unsigned)num_runs,
+        (unsigned long long)diff[SIM_FLASH_DEV_EXT].read_bytes,
+        (unsigned long long)diff[SIM_FLASH_DEV_INT].write_bytes,
+        (unsigned long long)diff[SIM_FLASH_DEV_INT].num_erased_pages,
+        (unsigned long long)(diff[SIM_FLASH_DEV_EXT].num_erased_pages + diff[SIM_FLASH_DEV_EXT].num_erased_blocks));
+    for (uint32_t i = 0; i < p_args->num_profiles; ++i)
+    {
+        const double ms = sim_timing_estimate_ms(p_args->profiles[i], SIM_FLASH_DEV_INT, &diff[SIM_FLASH_DEV_INT])
+                          + sim_timing_estimate_ms(p_args->profiles[i], SIM_FLASH_DEV_EXT, &diff[SIM_FLASH_DEV_EXT])
+                          + sim_timing_estimate_runs_ms(p_args->profiles[i], num_runs);
+        p_total_ms[i] += ms;
+        printf(" %22.1f", ms);
+    }
+    printf("\n");
+}
+
+static void
+sim_snapshot_stat(sim_flash_stat_t* const p_snapshot)
+{
+    for (uint32_t dev = 0; dev < SIM_FLASH_DEV_NUM; ++dev)
+    {
+        p_snapshot[dev] = *sim_flash_get_stat((sim_flash_dev_e)dev);
+    }
+}
+
+static int
+sim_cmd_simulate(const sim_args_t* const p_args)
+{
+    size_t         ext_size = 0;
+    size_t         int_size = 0;
+    uint8_t* const p_ext
+        = sim_load_dev(SIM_FLASH_DEV_EXT, p_args->p_ext, sim_flash_get_layout_end(SIM_FLASH_DEV_EXT), &ext_size);
+    uint8_t* const p_int = sim_load_dev(
+        SIM_FLASH_DEV_INT,
+        p_args->p_int,
+        MAX(SIM_INT_FLASH_SIZE, sim_flash_get_layout_end(SIM_FLASH_DEV_INT)),
+        &int_size);
+    if ((NULL == p_ext) || (NULL == p_int))
+    {
+        return EXIT_FAILURE;
+    }
+    sim_shim_set_downshift_steps(p_args->downshift_steps);
+
+    printf("Check images:\n");
+    if (!sim_check_images_in_ext_flash())
+    {
+        printf("Factory fw recovery would fail: images in external flash are not valid\n");
+        return EXIT_FAILURE;
+    }
+
+    double total_ms[SIM_TIMING_MAX_PROFILES] = { 0 };
+    printf("\n%-44s %4s %10s %10s %6s %6s", "Step", "Runs", "ExtRead,B", "IntWrite,B", "IntEr", "ExtEr");
+    for (uint32_t i = 0; i < p_args->num_profiles; ++i)
+    {
+        printf(" %19.19s,ms", p_args->profiles[i]->p_name);
+    }
+    printf("\n");
+
+    btldr_img_op_job_t jobs[SIM_NUM_RECOVERY_STEPS];
+    for (uint32_t i = 0; i < SIM_NUM_RECOVERY_STEPS; ++i)
+    {
+        const sim_recovery_step_t* const p_step = &g_recovery_steps[i];
+        jobs[i].fa_id_dst     = (fa_id_t)sim_flash_find_partition(p_step->p_fa_dst_name);
+        jobs[i].p_fa_dst_name = p_step->p_fa_dst_name;
+        jobs[i].fa_id_src     = (fa_id_t)sim_flash_find_partition(p_step->p_fa_src_name);
+        jobs[i].p_fa_src_name = p_step->p_fa_src_name;
+        jobs[i].is_verified   = false;
+    }
+
+    sim_flash_reset_stat();
+    sim_flash_stat_t before[SIM_FLASH_DEV_NUM];
+    uint32_t         runs_before = 0;
+    bool             is_ok       = true;
+    if (p_args->is_no_coalesce)
+    {
+        for (uint32_t i = 0; (i < SIM_NUM_RECOVERY_STEPS) && is_ok; ++i)
+        {
+            char step_name[2 * SIM_FLASH_NAME_MAX_LEN];
+            (void)snprintf(step_name, sizeof(step_name), "%s -> %s", jobs[i].p_fa_src_name, jobs[i].p_fa_dst_name);
+            sim_snapshot_stat(before);
+            runs_before = sim_shim_get_stat()->num_runs;
+            is_ok       = btldr_img_op_copy_and_verify_multi(&jobs[i], 1);
+            sim_print_step(p_args, step_name, before, sim_shim_get_stat()->num_runs - runs_before, total_ms);
+        }
+    }
+    else
+    {
+        sim_snapshot_stat(before);
+        is_ok = btldr_img_op_copy_and_verify_multi(jobs, SIM_NUM_RECOVERY_STEPS);
+        sim_print_step(p_args, "copy and verify", before, sim_shim_get_stat()->num_runs, total_ms);
+    }
+    for (uint32_t i = 0; i < SIM_NUM_RECOVERY_STEPS; ++i)
+    {
+        if (!jobs[i].is_verified)
+        {
+            printf("Factory fw recovery would fail: verification failed for %s\n", jobs[i].p_fa_dst_name);
+        }
+    }
+    if (!is_ok)
+    {
+        return EXIT_FAILURE;
+    }
+
+    const int userspace_id = sim_flash_find_partition(SIM_EXT_USERSPACE_NAME);
+    if (userspace_id >= 0)
+    {
+        const struct flash_area* const p_fa = &sim_flash_get_partition((uint8_t)userspace_id)->fa;
+        sim_snapshot_stat(before);
+        if (0 != flash_area_flatten(p_fa, 0, p_fa->fa_size))
+        {
+            printf("Factory fw recovery would fail: failed to erase %s\n", SIM_EXT_USERSPACE_NAME);
+            return EXIT_FAILURE;
+        }
+        sim_print_step(p_args, "erase " SIM_EXT_USERSPACE_NAME, before, 0, total_ms);
+    }
+
+    printf("%-44s %4s %10s %10s %6s %6s", "Total", "", "", "", "", "");
+    for (uint32_t i = 0; i < p_args->num_profiles; ++i)
+    {
+        printf(" %22.1f", total_ms[i]);
+    }
+    printf("\n\nVerification mismatches: %u\n", sim_shim_get_stat()->num_verify_mismatches);
+    printf("Flash operation slices: %u\n", sim_shim_get_stat()->num_slices);
+    if (0 != sim_shim_get_stat()->num_slice_errors)
+    {
+        printf("Slices reported for a wrong flash area: %u\n", sim_shim_get_stat()->num_slice_errors);
+        return EXIT_FAILURE;
+    }
+
+    if ((NULL != p_args->p_int_out) && !sim_image_save(p_args->p_int_out, p_int, int_size))
+    {
+        return EXIT_FAILURE;
+    }
+    if ((NULL != p_args->p_ext_out) && !sim_image_save(p_args->p_ext_out, p_ext, ext_size))
+    {
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
+
+static int
+sim_cmd_profiles(const sim_args_t* const p_args)
+{
+    for (uint32_t i = 0; i < p_args->num_profiles; ++i)
+    {
+        sim_timing_print_profile(p_args->profiles[i]);
+    }
+    return EXIT_SUCCESS;
+}
+
+int
+main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        sim_print_usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+    if (!sim_shim_check_address_space())
+    {
+        LOG_ERR("The simulator must be linked as a non-PIE executable");
+        return EXIT_FAILURE;
+    }
+    sim_args_t args = { 0 };
+    if (!sim_parse_args(argc, argv, &args))
+    {
+        return EXIT_FAILURE;
+    }
+    const char* const p_cmd = argv[1];
+    if (0 == strcmp(p_cmd, "profiles"))
+    {
+        return sim_cmd_profiles(&args);
+    }
+    if (!sim_load_layout(&args))
+    {
+        return EXIT_FAILURE;
+    }
+    if (0 == strcmp(p_cmd, "pack"))
+    {
+        return sim_cmd_pack(&args);
+    }
+    if (0 == strcmp(p_cmd, "check"))
+    {
+        return sim_cmd_check(&args);
+    }
+    if (0 == strcmp(p_cmd, "simulate"))
+    {
+        return sim_cmd_simulate(&args);
+    }
+    sim_print_usage(argv[0]);
+    return EXIT_FAILURE;
+}
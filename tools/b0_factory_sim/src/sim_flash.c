@@ -0,0 +1,248 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "sim_flash.h"
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+#include <zephyr/drivers/flash.h>
+#include <zephyr/logging/log.h>
+
+LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
+
+typedef struct sim_flash_dev_t
+{
+    struct device    dev;
+    uint8_t*         p_buf;
+    size_t           size;
+    size_t           page_size;
+    size_t           block_size;
+    sim_flash_stat_t stat;
+} sim_flash_dev_t;
+
+static sim_flash_dev_t g_sim_flash_devs[SIM_FLASH_DEV_NUM] = {
+    [SIM_FLASH_DEV_INT] = { .dev = { .name = "flash-controller@4001e000", .dev_idx = SIM_FLASH_DEV_INT } },
+    [SIM_FLASH_DEV_EXT] = { .dev = { .name = "mx25r6435f@0", .dev_idx = SIM_FLASH_DEV_EXT } },
+};
+
+static sim_flash_partition_t g_sim_flash_partitions[SIM_FLASH_MAX_PARTITIONS];
+static uint32_t              g_sim_flash_num_partitions;
+
+int
+sim_flash_add_partition(const char* const p_name, const sim_flash_dev_e dev, const uint32_t offset, const uint32_t size)
+{
+    if ((g_sim_flash_num_partitions >= SIM_FLASH_MAX_PARTITIONS) || (strlen(p_name) >= SIM_FLASH_NAME_MAX_LEN))
+    {
+        return -1;
+    }
+    const uint8_t          fa_id = (uint8_t)g_sim_flash_num_partitions;
+    sim_flash_partition_t* p_part = &g_sim_flash_partitions[fa_id];
+    (void)snprintf(p_part->name, sizeof(p_part->name), "%s", p_name);
+    p_part->fa.fa_id        = fa_id;
+    p_part->fa.fa_device_id = (uint8_t)dev;
+    p_part->fa.fa_off       = (off_t)offset;
+    p_part->fa.fa_size      = size;
+    p_part->fa.fa_dev       = &g_sim_flash_devs[dev].dev;
+    g_sim_flash_num_partitions += 1;
+    return fa_id;
+}
+
+int
+sim_flash_find_partition(const char* const p_name)
+{
+    for (uint32_t i = 0; i < g_sim_flash_num_partitions; ++i)
+    {
+        if (0 == strcmp(g_sim_flash_partitions[i].name, p_name))
+        {
+            return (int)i;
+        }
+    }
+    return -1;
+}
+
+const sim_flash_partition_t*
+sim_flash_get_partition(const uint8_t fa_id)
+{
+    if (fa_id >= g_sim_flash_num_partitions)
+    {
+        return NULL;
+    }
+    return &g_sim_flash_partitions[fa_id];
+}
+
+uint32_t
+sim_flash_get_layout_end(const sim_flash_dev_e dev)
+{
+    uint32_t end = 0;
+    for (uint32_t i = 0; i < g_sim_flash_num_partitions; ++i)
+    {
+        const struct flash_area* const p_fa = &g_sim_flash_partitions[i].fa;
+        if (p_fa->fa_device_id == (uint8_t)dev)
+        {
+            end = MAX(end, (uint32_t)p_fa->fa_off + (uint32_t)p_fa->fa_size);
+        }
+    }
+    return end;
+}
+
+void
+sim_flash_attach(
+    const sim_flash_dev_e dev,
+    uint8_t* const        p_buf,
+    const size_t          size,
+    const size_t          page_size,
+    const size_t          block_size)
+{
+    g_sim_flash_devs[dev].p_buf      = p_buf;
+    g_sim_flash_devs[dev].size       = size;
+    g_sim_flash_devs[dev].page_size  = page_size;
+    g_sim_flash_devs[dev].block_size = block_size;
+}
+
+void
+sim_flash_reset_stat(void)
+{
+    for (uint32_t i = 0; i < SIM_FLASH_DEV_NUM; ++i)
+    {
+        memset(&g_sim_flash_devs[i].stat, 0, sizeof(g_sim_flash_devs[i].stat));
+    }
+}
+
+const sim_flash_stat_t*
+sim_flash_get_stat(const sim_flash_dev_e dev)
+{
+    return &g_sim_flash_devs[dev].stat;
+}
+
+const char*
+sim_flash_get_dev_name(const sim_flash_dev_e dev)
+{
+    return (SIM_FLASH_DEV_INT == dev) ? "int" : "ext";
+}
+
+const uint8_t*
+sim_flash_get_int_base(void)
+{
+    return g_sim_flash_devs[SIM_FLASH_DEV_INT].p_buf;
+}
+
+static sim_flash_dev_t*
+sim_flash_get_dev(const struct flash_area* const fa, const off_t off, const size_t len)
+{
+    sim_flash_dev_t* const p_dev = &g_sim_flash_devs[fa->fa_dev->dev_idx];
+    if ((NULL == p_dev->p_buf) || (off < 0) || (((size_t)off + len) > fa->fa_size)
+        || (((size_t)fa->fa_off + fa->fa_size) > p_dev->size))
+    {
+        LOG_ERR("Access out of range: flash area %d, offset 0x%08lx, len 0x%zx", fa->fa_id, (long)off, len);
+        return NULL;
+    }
+    return p_dev;
+}
+
+int
+flash_area_open(uint8_t id, const struct flash_area** fa)
+{
+    const sim_flash_partition_t* const p_part = sim_flash_get_partition(id);
+    if (NULL == p_part)
+    {
+        return -ENOENT;
+    }
+    *fa = &p_part->fa;
+    return 0;
+}
+
+void
+flash_area_close(const struct flash_area* fa)
+{
+    (void)fa;
+}
+
+int
+flash_area_read(const struct flash_area* fa, off_t off, void* dst, size_t len)
+{
+    sim_flash_dev_t* const p_dev = sim_flash_get_dev(fa, off, len);
+    if (NULL == p_dev)
+    {
+        return -EINVAL;
+    }
+    memcpy(dst, &p_dev->p_buf[(size_t)fa->fa_off + (size_t)off], len);
+    p_dev->stat.num_read_ops += 1;
+    p_dev->stat.read_bytes += len;
+    return 0;
+}
+
+int
+flash_area_write(const struct flash_area* fa, off_t off, const void* src, size_t len)
+{
+    sim_flash_dev_t* const p_dev = sim_flash_get_dev(fa, off, len);
+    if (NULL == p_dev)
+    {
+        return -EINVAL;
+    }
+    /* NOR flash programming can only clear bits. */
+    const uint8_t* const p_src = src;
+    uint8_t* const       p_dst = &p_dev->p_buf[(size_t)fa->fa_off + (size_t)off];
+    for (size_t i = 0; i < len; ++i)
+    {
+        p_dst[i] &= p_src[i];
+    }
+    p_dev->stat.num_write_ops += 1;
+    p_dev->stat.write_bytes += len;
+    return 0;
+}
+
+int
+flash_area_erase(const struct flash_area* fa, off_t off, size_t len)
+{
+    sim_flash_dev_t* const p_dev = sim_flash_get_dev(fa, off, len);
+    if (NULL == p_dev)
+    {
+        return -EINVAL;
+    }
+    const size_t abs_off = (size_t)fa->fa_off + (size_t)off;
+    if ((0 != (abs_off % p_dev->page_size)) || (0 != (len % p_dev->page_size)))
+    {
+        LOG_ERR("Erase is not aligned to page: address 0x%08zx, len 0x%zx", abs_off, len);
+        return -EINVAL;
+    }
+    memset(&p_dev->p_buf[abs_off], 0xFF, len);
+
+    /* Like the QSPI NOR driver, use block erase for aligned ranges and sector erase for the rest. */
+    size_t pos = abs_off;
+    while (pos < (abs_off + len))
+    {
+        const size_t rem = (abs_off + len) - pos;
+        if ((0 != p_dev->block_size) && (0 == (pos % p_dev->block_size)) && (rem >= p_dev->block_size))
+        {
+            p_dev->stat.num_erased_blocks += 1;
+            pos += p_dev->block_size;
+        }
+        else
+        {
+            p_dev->stat.num_erased_pages += 1;
+            pos += p_dev->page_size;
+        }
+    }
+    return 0;
+}
+
+int
+flash_area_flatten(const struct flash_area* fa, off_t off, size_t len)
+{
+    return flash_area_erase(fa, off, len);
+}
+
+int
+flash_get_page_info_by_offs(const struct device* dev, off_t offset, struct flash_pages_info* info)
+{
+    const sim_flash_dev_t* const p_dev = &g_sim_flash_devs[dev->dev_idx];
+    if ((offset < 0) || ((size_t)offset >= p_dev->size))
+    {
+        return -EINVAL;
+    }
+    info->index        = (uint32_t)((size_t)offset / p_dev->page_size);
+    info->start_offset = (off_t)(info->index * p_dev->page_size);
+    info->size         = p_dev->page_size;
+    return 0;
+}
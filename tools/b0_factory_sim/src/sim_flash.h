@@ -0,0 +1,95 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef SIM_FLASH_H
+#define SIM_FLASH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <zephyr/storage/flash_map.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIM_FLASH_MAX_PARTITIONS 64
+#define SIM_FLASH_NAME_MAX_LEN   48
+
+typedef enum sim_flash_dev_e
+{
+    SIM_FLASH_DEV_INT = 0, //!< nRF52840 internal flash (memory-mapped)
+    SIM_FLASH_DEV_EXT = 1, //!< External QSPI NOR flash
+    SIM_FLASH_DEV_NUM,
+} sim_flash_dev_e;
+
+typedef struct sim_flash_stat_t
+{
+    uint64_t num_read_ops;
+    uint64_t read_bytes;
+    uint64_t num_write_ops;
+    uint64_t write_bytes;
+    uint64_t num_erased_pages;  //!< Number of erased pages (sectors) which are not part of an erased block
+    uint64_t num_erased_blocks; //!< Number of erased blocks (used by external flash for aligned 64 KiB ranges)
+} sim_flash_stat_t;
+
+typedef struct sim_flash_partition_t
+{
+    char              name[SIM_FLASH_NAME_MAX_LEN];
+    struct flash_area fa;
+} sim_flash_partition_t;
+
+/**
+ * @brief Add a partition to the layout.
+ * @return Flash area ID of the partition or -1 on error.
+ */
+int
+sim_flash_add_partition(
+    const char* const     p_name,
+    const sim_flash_dev_e dev,
+    const uint32_t        offset,
+    const uint32_t        size);
+
+/**
+ * @brief Find a partition by its name (as in partitions.yml).
+ * @return Flash area ID of the partition or -1 if it is not found.
+ */
+int
+sim_flash_find_partition(const char* const p_name);
+
+const sim_flash_partition_t*
+sim_flash_get_partition(const uint8_t fa_id);
+
+/**
+ * @brief Get the size of the device which is needed to hold all its partitions.
+ */
+uint32_t
+sim_flash_get_layout_end(const sim_flash_dev_e dev);
+
+/**
+ * @brief Attach a memory buffer with the content of the device (erased bytes are 0xFF).
+ * @param block_size - size of the large erase unit or 0 if the device can erase only pages.
+ */
+void
+sim_flash_attach(
+    const sim_flash_dev_e dev,
+    uint8_t* const        p_buf,
+    const size_t          size,
+    const size_t          page_size,
+    const size_t          block_size);
+
+void
+sim_flash_reset_stat(void);
+
+const sim_flash_stat_t*
+sim_flash_get_stat(const sim_flash_dev_e dev);
+
+const char*
+sim_flash_get_dev_name(const sim_flash_dev_e dev);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_FLASH_H
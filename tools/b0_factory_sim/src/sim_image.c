@@ -0,0 +1,227 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "sim_image.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/storage/flash_map.h>
+
+LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
+
+#define SIM_IMAGE_HEX_LINE_MAX_LEN 600
+#define SIM_IMAGE_HEX_MAX_DATA_LEN 255
+
+#define SIM_IMAGE_HEX_REC_DATA             0x00
+#define SIM_IMAGE_HEX_REC_EOF              0x01
+#define SIM_IMAGE_HEX_REC_EXT_SEGMENT_ADDR 0x02
+#define SIM_IMAGE_HEX_REC_EXT_LINEAR_ADDR  0x04
+
+typedef void (*sim_image_hex_cb_t)(const uint32_t addr, const uint8_t* const p_data, const size_t len, void* p_ctx);
+
+typedef struct sim_image_hex_range_t
+{
+    uint32_t min_addr;
+    uint32_t max_addr;
+} sim_image_hex_range_t;
+
+typedef struct sim_image_hex_buf_t
+{
+    uint8_t* p_buf;
+    uint32_t base_addr;
+} sim_image_hex_buf_t;
+
+static bool
+sim_image_parse_hex_byte(const char* const p_str, uint8_t* const p_byte)
+{
+    char tmp[3] = { p_str[0], p_str[1], '\0' };
+    char* p_end = NULL;
+    *p_byte     = (uint8_t)strtoul(tmp, &p_end, 16);
+    return (p_end == &tmp[2]);
+}
+
+static bool
+sim_image_parse_hex(const char* const p_path, sim_image_hex_cb_t cb, void* p_ctx)
+{
+    FILE* const p_file = fopen(p_path, "r");
+    if (NULL == p_file)
+    {
+        LOG_ERR("Failed to open %s", p_path);
+        return false;
+    }
+    bool     is_ok     = false;
+    uint32_t addr_base = 0;
+    char     line[SIM_IMAGE_HEX_LINE_MAX_LEN];
+    uint8_t  rec[SIM_IMAGE_HEX_MAX_DATA_LEN + 5];
+    while (NULL != fgets(line, sizeof(line), p_file))
+    {
+        if (':' != line[0])
+        {
+            continue;
+        }
+        size_t rec_len = 0;
+        while ((rec_len < sizeof(rec)) && sim_image_parse_hex_byte(&line[1 + (rec_len * 2)], &rec[rec_len]))
+        {
+            rec_len += 1;
+        }
+        if ((rec_len < 5) || (rec_len != ((size_t)rec[0] + 5)))
+        {
+            LOG_ERR("Invalid record in %s: %s", p_path, line);
+            break;
+        }
+        uint8_t checksum = 0;
+        for (size_t i = 0; i < rec_len; ++i)
+        {
+            checksum += rec[i];
+        }
+        if (0 != checksum)
+        {
+            LOG_ERR("Invalid checksum in %s: %s", p_path, line);
+            break;
+        }
+        const uint32_t offset = ((uint32_t)rec[1] << 8) | rec[2];
+        const uint8_t  type   = rec[3];
+        if (SIM_IMAGE_HEX_REC_DATA == type)
+        {
+            cb(addr_base + offset, &rec[4], rec[0], p_ctx);
+        }
+        else if (SIM_IMAGE_HEX_REC_EOF == type)
+        {
+            is_ok = true;
+            break;
+        }
+        else if (SIM_IMAGE_HEX_REC_EXT_SEGMENT_ADDR == type)
+        {
+            addr_base = (((uint32_t)rec[4] << 8) | rec[5]) << 4;
+        }
+        else if (SIM_IMAGE_HEX_REC_EXT_LINEAR_ADDR == type)
+        {
+            addr_base = (((uint32_t)rec[4] << 8) | rec[5]) << 16;
+        }
+        else
+        {
+            // Start address records are not needed
+        }
+    }
+    (void)fclose(p_file);
+    if (!is_ok)
+    {
+        LOG_ERR("Failed to parse %s", p_path);
+    }
+    return is_ok;
+}
+
+static void
+sim_image_hex_cb_range(const uint32_t addr, const uint8_t* const p_data, const size_t len, void* p_ctx)
+{
+    (void)p_data;
+    sim_image_hex_range_t* const p_range = p_ctx;
+    p_range->min_addr                    = MIN(p_range->min_addr, addr);
+    p_range->max_addr                    = MAX(p_range->max_addr, addr + (uint32_t)len);
+}
+
+static void
+sim_image_hex_cb_copy(const uint32_t addr, const uint8_t* const p_data, const size_t len, void* p_ctx)
+{
+    sim_image_hex_buf_t* const p_hex_buf = p_ctx;
+    memcpy(&p_hex_buf->p_buf[addr - p_hex_buf->base_addr], p_data, len);
+}
+
+static bool
+sim_image_load_hex(const char* const p_path, const uint32_t base_addr, uint8_t** const pp_buf, size_t* const p_size)
+{
+    sim_image_hex_range_t range = { .min_addr = UINT32_MAX, .max_addr = 0 };
+    if (!sim_image_parse_hex(p_path, &sim_image_hex_cb_range, &range))
+    {
+        return false;
+    }
+    if (range.min_addr >= range.max_addr)
+    {
+        LOG_ERR("No data in %s", p_path);
+        return false;
+    }
+    sim_image_hex_buf_t hex_buf = {
+        .p_buf     = NULL,
+        .base_addr = (SIM_IMAGE_BASE_ADDR_AUTO == base_addr) ? range.min_addr : base_addr,
+    };
+    if (range.min_addr < hex_buf.base_addr)
+    {
+        LOG_ERR("%s contains data at 0x%08x which is below 0x%08x", p_path, range.min_addr, hex_buf.base_addr);
+        return false;
+    }
+    const size_t size = range.max_addr - hex_buf.base_addr;
+    hex_buf.p_buf     = malloc(size);
+    if (NULL == hex_buf.p_buf)
+    {
+        return false;
+    }
+    memset(hex_buf.p_buf, 0xFF, size);
+    (void)sim_image_parse_hex(p_path, &sim_image_hex_cb_copy, &hex_buf);
+    *pp_buf = hex_buf.p_buf;
+    *p_size = size;
+    return true;
+}
+
+static bool
+sim_image_load_bin(const char* const p_path, uint8_t** const pp_buf, size_t* const p_size)
+{
+    FILE* const p_file = fopen(p_path, "rb");
+    if (NULL == p_file)
+    {
+        LOG_ERR("Failed to open %s", p_path);
+        return false;
+    }
+    bool is_ok = false;
+    if ((0 == fseek(p_file, 0, SEEK_END)) && (ftell(p_file) > 0))
+    {
+        const size_t size  = (size_t)ftell(p_file);
+        uint8_t*     p_buf = malloc(size);
+        if ((NULL != p_buf) && (0 == fseek(p_file, 0, SEEK_SET)) && (size == fread(p_buf, 1, size, p_file)))
+        {
+            *pp_buf = p_buf;
+            *p_size = size;
+            is_ok   = true;
+        }
+        else
+        {
+            free(p_buf);
+        }
+    }
+    (void)fclose(p_file);
+    if (!is_ok)
+    {
+        LOG_ERR("Failed to read %s", p_path);
+    }
+    return is_ok;
+}
+
+bool
+sim_image_load(const char* const p_path, const uint32_t base_addr, uint8_t** const pp_buf, size_t* const p_size)
+{
+    const char* const p_ext = strrchr(p_path, '.');
+    if ((NULL != p_ext) && (0 == strcmp(p_ext, ".hex")))
+    {
+        return sim_image_load_hex(p_path, base_addr, pp_buf, p_size);
+    }
+    return sim_image_load_bin(p_path, pp_buf, p_size);
+}
+
+bool
+sim_image_save(const char* const p_path, const uint8_t* const p_buf, const size_t size)
+{
+    FILE* const p_file = fopen(p_path, "wb");
+    if (NULL == p_file)
+    {
+        LOG_ERR("Failed to create %s", p_path);
+        return false;
+    }
+    const bool is_ok = (size == fwrite(p_buf, 1, size, p_file));
+    if ((0 != fclose(p_file)) || !is_ok)
+    {
+        LOG_ERR("Failed to write %s", p_path);
+        return false;
+    }
+    return true;
+}
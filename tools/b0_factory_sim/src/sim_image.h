@@ -0,0 +1,34 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef SIM_IMAGE_H
+#define SIM_IMAGE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIM_IMAGE_BASE_ADDR_AUTO UINT32_MAX
+
+/**
+ * @brief Load a binary file or an Intel HEX file (detected by the '.hex' extension).
+ * @param base_addr - address which corresponds to the first byte of the output buffer for Intel HEX files,
+ *                    or SIM_IMAGE_BASE_ADDR_AUTO to use the lowest address in the file.
+ * @param[out] pp_buf - allocated buffer (must be freed by the caller), gaps are filled with 0xFF.
+ */
+bool
+sim_image_load(const char* const p_path, const uint32_t base_addr, uint8_t** const pp_buf, size_t* const p_size);
+
+bool
+sim_image_save(const char* const p_path, const uint8_t* const p_buf, const size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_IMAGE_H
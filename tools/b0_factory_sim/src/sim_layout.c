@@ -0,0 +1,142 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "sim_layout.h"
+#include <ctype.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/logging/log.h>
+#include "sim_flash.h"
+
+LOG_MODULE_DECLARE(B0, LOG_LEVEL_INF);
+
+#define SIM_LAYOUT_LINE_MAX_LEN 256
+
+typedef struct sim_layout_entry_t
+{
+    char     name[SIM_FLASH_NAME_MAX_LEN];
+    char     region[SIM_FLASH_NAME_MAX_LEN];
+    uint32_t address;
+    uint32_t size;
+    bool     has_address;
+    bool     has_size;
+} sim_layout_entry_t;
+
+static void
+sim_layout_add_entry(const sim_layout_entry_t* const p_entry)
+{
+    if (('\0' == p_entry->name[0]) || (!p_entry->has_address) || (!p_entry->has_size))
+    {
+        return;
+    }
+    sim_flash_dev_e dev = SIM_FLASH_DEV_NUM;
+    if (0 == strcmp(p_entry->region, "flash_primary"))
+    {
+        dev = SIM_FLASH_DEV_INT;
+    }
+    else if (0 == strcmp(p_entry->region, "external_flash"))
+    {
+        dev = SIM_FLASH_DEV_EXT;
+    }
+    else
+    {
+        return;
+    }
+    if (sim_flash_add_partition(p_entry->name, dev, p_entry->address, p_entry->size) < 0)
+    {
+        LOG_ERR("Failed to add partition %s", p_entry->name);
+    }
+}
+
+static char*
+sim_layout_strip(char* p_str)
+{
+    while (isspace((unsigned char)*p_str))
+    {
+        p_str += 1;
+    }
+    size_t len = strlen(p_str);
+    while ((len > 0) && isspace((unsigned char)p_str[len - 1]))
+    {
+        p_str[--len] = '\0';
+    }
+    return p_str;
+}
+
+static void
+sim_layout_parse_attr(sim_layout_entry_t* const p_entry, char* const p_line)
+{
+    char* const p_colon = strchr(p_line, ':');
+    if (NULL == p_colon)
+    {
+        return;
+    }
+    *p_colon                  = '\0';
+    const char* const p_key   = sim_layout_strip(p_line);
+    const char* const p_value = sim_layout_strip(p_colon + 1);
+    if (0 == strcmp(p_key, "address"))
+    {
+        p_entry->address     = (uint32_t)strtoul(p_value, NULL, 0);
+        p_entry->has_address = true;
+    }
+    else if (0 == strcmp(p_key, "size"))
+    {
+        p_entry->size     = (uint32_t)strtoul(p_value, NULL, 0);
+        p_entry->has_size = true;
+    }
+    else if (0 == strcmp(p_key, "region"))
+    {
+        (void)snprintf(p_entry->region, sizeof(p_entry->region), "%s", p_value);
+    }
+    else
+    {
+        // Other attributes are not needed
+    }
+}
+
+bool
+sim_layout_load(const char* const p_path)
+{
+    FILE* const p_file = fopen(p_path, "r");
+    if (NULL == p_file)
+    {
+        LOG_ERR("Failed to open %s", p_path);
+        return false;
+    }
+
+    sim_layout_entry_t entry = { 0 };
+    char               line[SIM_LAYOUT_LINE_MAX_LEN];
+    while (NULL != fgets(line, sizeof(line), p_file))
+    {
+        if (('#' == line[0]) || ('\n' == line[0]))
+        {
+            continue;
+        }
+        if (!isspace((unsigned char)line[0]))
+        {
+            // Top-level key is the name of the next partition
+            sim_layout_add_entry(&entry);
+            memset(&entry, 0, sizeof(entry));
+            char* const p_colon = strchr(line, ':');
+            if (NULL != p_colon)
+            {
+                *p_colon = '\0';
+                (void)snprintf(entry.name, sizeof(entry.name), "%s", sim_layout_strip(line));
+            }
+        }
+        else if ((' ' == line[0]) && (' ' == line[1]) && !isspace((unsigned char)line[2]))
+        {
+            sim_layout_parse_attr(&entry, line);
+        }
+        else
+        {
+            // Nested attributes (e.g. 'placement' or 'span') are not needed
+        }
+    }
+    sim_layout_add_entry(&entry);
+    (void)fclose(p_file);
+    return true;
+}
@@ -0,0 +1,26 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef SIM_LAYOUT_H
+#define SIM_LAYOUT_H
+
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Load partitions from partitions.yml generated by the nRF Connect SDK Partition Manager.
+ * @note Partitions in 'flash_primary' region are placed to the internal flash,
+ *       partitions in 'external_flash' region are placed to the external flash, other regions are ignored.
+ */
+bool
+sim_layout_load(const char* const p_path);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_LAYOUT_H
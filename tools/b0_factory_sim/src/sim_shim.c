@@ -0,0 +1,152 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "sim_shim.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <cmsis_gcc.h>
+#include <fw_info_bare.h>
+#include <zephyr/storage/flash_map.h>
+#include "btldr_img_op.h"
+#include "sim_flash.h"
+
+LOG_MODULE_REGISTER(B0, LOG_LEVEL_INF);
+
+static int             g_sim_log_level = LOG_LEVEL_WRN;
+static uint32_t        g_sim_downshift_steps;
+static sim_shim_stat_t g_sim_shim_stat;
+
+void
+sim_shim_set_log_level(const int level)
+{
+    g_sim_log_level = level;
+}
+
+void
+sim_shim_set_downshift_steps(const uint32_t num_steps)
+{
+    g_sim_downshift_steps = num_steps;
+}
+
+const sim_shim_stat_t*
+sim_shim_get_stat(void)
+{
+    return &g_sim_shim_stat;
+}
+
+bool
+sim_shim_check_address_space(void)
+{
+    return ((uintptr_t)&g_sim_shim_stat <= UINT32_MAX);
+}
+
+void
+sim_log(const int level, const char* const p_fmt, ...)
+{
+    static const char* const g_level_names[] = { "", "ERR", "WRN", "INF", "DBG" };
+
+    if (level > g_sim_log_level)
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, p_fmt);
+    fprintf(stderr, "[%s] ", g_level_names[level]);
+    vfprintf(stderr, p_fmt, args);
+    fprintf(stderr, "\n");
+    va_end(args);
+}
+
+void
+sim_log_hexdump(const int level, const void* const p_data, const size_t len, const char* const p_title)
+{
+    if (level > g_sim_log_level)
+    {
+        return;
+    }
+    const uint8_t* const p_bytes = p_data;
+    fprintf(stderr, "%s", p_title);
+    for (size_t i = 0; i < len; ++i)
+    {
+        fprintf(stderr, "%s%02x", (0 == (i % 16)) ? "\n  " : " ", p_bytes[i]);
+    }
+    fprintf(stderr, "\n");
+}
+
+const struct fw_info*
+fw_info_find(uint32_t firmware_address)
+{
+    static const uint32_t g_fw_info_offsets[] = {
+        FW_INFO_OFFSET0, FW_INFO_OFFSET1, FW_INFO_OFFSET2, FW_INFO_OFFSET3, FW_INFO_OFFSET4,
+    };
+    for (size_t i = 0; i < (sizeof(g_fw_info_offsets) / sizeof(g_fw_info_offsets[0])); ++i)
+    {
+        const uint8_t* const p_candidate = (const uint8_t*)(uintptr_t)(firmware_address + g_fw_info_offsets[i]);
+        uint32_t             magic[2]    = { 0 };
+        memcpy(magic, p_candidate, sizeof(magic));
+        if ((FW_INFO_MAGIC_COMMON == magic[0]) && (FW_INFO_MAGIC_FW_INFO == magic[1]))
+        {
+            return (const struct fw_info*)p_candidate;
+        }
+    }
+    return NULL;
+}
+
+__NO_RETURN void
+on_factory_fw_recovery_fail(void)
+{
+    LOG_ERR("B0: Factory fw recovery failed");
+    exit(EXIT_FAILURE);
+}
+
+void
+btldr_img_op_on_verify_begin(void)
+{
+    g_sim_shim_stat.num_runs += 1;
+}
+
+void
+btldr_img_op_on_verify_end(void)
+{
+}
+
+bool
+btldr_img_op_on_verify_mismatch(void)
+{
+    g_sim_shim_stat.num_verify_mismatches += 1;
+    if (0 == g_sim_downshift_steps)
+    {
+        return false;
+    }
+    g_sim_downshift_steps -= 1;
+    return true;
+}
+
+void
+btldr_img_op_on_page_done(void)
+{
+    g_sim_shim_stat.num_pages_done += 1;
+}
+
+int
+btldr_img_op_erase_page(const struct flash_area* const p_fa, const off_t page_offset, const size_t page_size)
+{
+    return flash_area_erase(p_fa, page_offset, page_size);
+}
+
+void
+btldr_img_op_on_slice(const btldr_img_op_stage_e stage, const struct flash_area* const p_fa, const off_t offset)
+{
+    (void)stage;
+    g_sim_shim_stat.num_slices += 1;
+    /* Checkpoints on the device refer to the flash area and the offset, so they must describe a real partition. */
+    const sim_flash_partition_t* const p_part = sim_flash_get_partition(p_fa->fa_id);
+    if ((NULL == p_part) || (p_fa != &p_part->fa) || (offset <= 0) || ((size_t)offset > p_fa->fa_size))
+    {
+        LOG_ERR("Slice at offset 0x%08x of flash area %d does not belong to it", (unsigned)offset, p_fa->fa_id);
+        g_sim_shim_stat.num_slice_errors += 1;
+    }
+}
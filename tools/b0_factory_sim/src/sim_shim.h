@@ -0,0 +1,48 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef SIM_SHIM_H
+#define SIM_SHIM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <zephyr/logging/log.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct sim_shim_stat_t
+{
+    uint32_t num_verify_mismatches;
+    uint32_t num_pages_done;
+    uint32_t num_slices;
+    uint32_t num_runs;         //!< Number of copy/verify runs (btldr_img_op_on_verify_begin calls)
+    uint32_t num_slice_errors; //!< Slices reported for a flash area or offset which does not exist
+} sim_shim_stat_t;
+
+void
+sim_shim_set_log_level(const int level);
+
+/**
+ * @brief Set how many times the source may be re-read after a verification mismatch
+ *        (this corresponds to the number of slower QSPI profiles available on the device).
+ */
+void
+sim_shim_set_downshift_steps(const uint32_t num_steps);
+
+const sim_shim_stat_t*
+sim_shim_get_stat(void);
+
+/**
+ * @brief Check that static data is placed below 4 GiB, because the firmware code passes addresses as uint32_t.
+ */
+bool
+sim_shim_check_address_space(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_SHIM_H
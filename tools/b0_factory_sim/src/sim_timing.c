@@ -0,0 +1,125 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#include "sim_timing.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SIM_TIMING_BYTES_PER_MB (1000.0 * 1000.0)
+
+/* nRF52840 NVMC: tWRITE = 41 us, tERASEPAGE = 85 ms (maximum values from the product specification).
+ * MX25R6435F in high performance mode: tSE = 40 ms, tBE64K = 250 ms (typical values).
+ * run_setup_us is an estimate which has not been measured on the device. */
+static sim_timing_profile_t g_sim_timing_profiles[SIM_TIMING_MAX_PROFILES] = {
+    { "qspi-8mhz-fastread", 64.0, 41.0, 85.0, 1.0, 20.0, 40.0, 250.0, 100.0 },
+    { "qspi-16mhz-read2io", 64.0, 41.0, 85.0, 4.0, 15.0, 40.0, 250.0, 100.0 },
+    { "qspi-32mhz-read4io", 64.0, 41.0, 85.0, 16.0, 10.0, 40.0, 250.0, 100.0 },
+};
+static const uint32_t g_sim_timing_num_profiles = 3;
+
+typedef struct sim_timing_param_t
+{
+    const char* p_name;
+    size_t      offset;
+} sim_timing_param_t;
+
+static const sim_timing_param_t g_sim_timing_params[] = {
+    { "int_read_mbps", offsetof(sim_timing_profile_t, int_read_mbps) },
+    { "int_write_us_per_word", offsetof(sim_timing_profile_t, int_write_us_per_word) },
+    { "int_page_erase_ms", offsetof(sim_timing_profile_t, int_page_erase_ms) },
+    { "ext_read_mbps", offsetof(sim_timing_profile_t, ext_read_mbps) },
+    { "ext_read_op_us", offsetof(sim_timing_profile_t, ext_read_op_us) },
+    { "ext_sector_erase_ms", offsetof(sim_timing_profile_t, ext_sector_erase_ms) },
+    { "ext_block_erase_ms", offsetof(sim_timing_profile_t, ext_block_erase_ms) },
+    { "run_setup_us", offsetof(sim_timing_profile_t, run_setup_us) },
+};
+
+uint32_t
+sim_timing_get_num_profiles(void)
+{
+    return g_sim_timing_num_profiles;
+}
+
+sim_timing_profile_t*
+sim_timing_get_profile(const uint32_t idx)
+{
+    return (idx < g_sim_timing_num_profiles) ? &g_sim_timing_profiles[idx] : NULL;
+}
+
+sim_timing_profile_t*
+sim_timing_find_profile(const char* const p_name)
+{
+    for (uint32_t i = 0; i < g_sim_timing_num_profiles; ++i)
+    {
+        if (0 == strcmp(g_sim_timing_profiles[i].p_name, p_name))
+        {
+            return &g_sim_timing_profiles[i];
+        }
+    }
+    return NULL;
+}
+
+bool
+sim_timing_set_param(sim_timing_profile_t* const p_profile, const char* const p_assignment)
+{
+    const char* const p_eq = strchr(p_assignment, '=');
+    if (NULL == p_eq)
+    {
+        return false;
+    }
+    const size_t name_len = (size_t)(p_eq - p_assignment);
+    for (size_t i = 0; i < (sizeof(g_sim_timing_params) / sizeof(g_sim_timing_params[0])); ++i)
+    {
+        const sim_timing_param_t* const p_param = &g_sim_timing_params[i];
+        if ((strlen(p_param->p_name) == name_len) && (0 == strncmp(p_param->p_name, p_assignment, name_len)))
+        {
+            char*        p_end = NULL;
+            const double val   = strtod(p_eq + 1, &p_end);
+            if ((p_end == (p_eq + 1)) || ('\0' != *p_end) || (val <= 0.0))
+            {
+                return false;
+            }
+            *(double*)((uint8_t*)p_profile + p_param->offset) = val;
+            return true;
+        }
+    }
+    return false;
+}
+
+double
+sim_timing_estimate_ms(
+    const sim_timing_profile_t* const p_profile,
+    const sim_flash_dev_e             dev,
+    const sim_flash_stat_t* const     p_stat)
+{
+    if (SIM_FLASH_DEV_INT == dev)
+    {
+        return ((double)p_stat->read_bytes * 1000.0 / (p_profile->int_read_mbps * SIM_TIMING_BYTES_PER_MB))
+               + (((double)p_stat->write_bytes / 4.0) * p_profile->int_write_us_per_word / 1000.0)
+               + ((double)p_stat->num_erased_pages * p_profile->int_page_erase_ms);
+    }
+    return ((double)p_stat->read_bytes * 1000.0 / (p_profile->ext_read_mbps * SIM_TIMING_BYTES_PER_MB))
+           + ((double)p_stat->num_read_ops * p_profile->ext_read_op_us / 1000.0)
+           + ((double)p_stat->num_erased_pages * p_profile->ext_sector_erase_ms)
+           + ((double)p_stat->num_erased_blocks * p_profile->ext_block_erase_ms);
+}
+
+double
+sim_timing_estimate_runs_ms(const sim_timing_profile_t* const p_profile, const uint32_t num_runs)
+{
+    return (double)num_runs * p_profile->run_setup_us / 1000.0;
+}
+
+void
+sim_timing_print_profile(const sim_timing_profile_t* const p_profile)
+{
+    printf("%s:\n", p_profile->p_name);
+    for (size_t i = 0; i < (sizeof(g_sim_timing_params) / sizeof(g_sim_timing_params[0])); ++i)
+    {
+        const sim_timing_param_t* const p_param = &g_sim_timing_params[i];
+        printf("  %-22s %g\n", p_param->p_name, *(const double*)((const uint8_t*)p_profile + p_param->offset));
+    }
+}
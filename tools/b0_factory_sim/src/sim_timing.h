@@ -0,0 +1,70 @@
+/**
+ * @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+ */
+
+#ifndef SIM_TIMING_H
+#define SIM_TIMING_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "sim_flash.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SIM_TIMING_MAX_PROFILES 8
+
+typedef struct sim_timing_profile_t
+{
+    const char* p_name;
+    double      int_read_mbps;         //!< Internal flash read throughput (memory-mapped), MB/s
+    double      int_write_us_per_word; //!< Internal flash program time per 32-bit word, us
+    double      int_page_erase_ms;     //!< Internal flash page erase time, ms
+    double      ext_read_mbps;         //!< External flash read throughput on the QSPI bus, MB/s
+    double      ext_read_op_us;        //!< Overhead of each read from external flash (command, address, driver), us
+    double      ext_sector_erase_ms;   //!< External flash 4 KiB sector erase time, ms
+    double      ext_block_erase_ms;    //!< External flash 64 KiB block erase time, ms
+    double      run_setup_us;          //!< Cost of each copy/verify run apart from the flash operations, us
+} sim_timing_profile_t;
+
+uint32_t
+sim_timing_get_num_profiles(void);
+
+sim_timing_profile_t*
+sim_timing_get_profile(const uint32_t idx);
+
+sim_timing_profile_t*
+sim_timing_find_profile(const char* const p_name);
+
+/**
+ * @brief Override a parameter of the profile.
+ * @param p_assignment - string in the form "<parameter>=<value>", e.g. "ext_read_mbps=8".
+ */
+bool
+sim_timing_set_param(sim_timing_profile_t* const p_profile, const char* const p_assignment);
+
+/**
+ * @brief Estimate the duration of the flash operations in milliseconds.
+ */
+double
+sim_timing_estimate_ms(
+    const sim_timing_profile_t* const p_profile,
+    const sim_flash_dev_e             dev,
+    const sim_flash_stat_t* const     p_stat);
+
+/**
+ * @brief Estimate the duration of starting the copy/verify runs in milliseconds
+ *        (opening the flash areas and switching the QSPI settings for the verification and back).
+ */
+double
+sim_timing_estimate_runs_ms(const sim_timing_profile_t* const p_profile, const uint32_t num_runs);
+
+void
+sim_timing_print_profile(const sim_timing_profile_t* const p_profile);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // SIM_TIMING_H
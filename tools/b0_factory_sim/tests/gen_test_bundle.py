@@ -0,0 +1,105 @@
+#!/usr/bin/env python3
+# @copyright Ruuvi Innovations Ltd, license BSD-3-Clause.
+"""
+Generate test data for the CTest targets of b0_factory_sim.
+
+Usage:
+    gen_test_bundle.py <out_dir>
+
+Writes partitions.yml, images for every factory partition (s0/s1/mcuboot_* contain a fw_info,
+mcuboot_secondary is written as Intel HEX), s0_bad.bin without fw_info and int_expected.bin:
+the internal flash expected after the factory fw recovery of the bundle packed from these images.
+"""
+
+import os
+import random
+import struct
+import sys
+
+INT_FLASH_SIZE = 1024 * 1024
+FW_INFO_OFFSET = 0x200
+FW_INFO_MAGIC_COMMON = 0x281EE6DE
+FW_INFO_MAGIC_FW_INFO = 0x8FCEBB4C
+
+# name: (internal address, external address, size)
+PARTITIONS = {
+    "provision": (0x8000, 0x0, 0x1000),
+    "s0": (0x9000, 0x1000, 0x10000),
+    "s1": (0x19000, 0x11000, 0x10000),
+    "mcuboot_primary": (0x29000, 0x21000, 0x20000),
+    "mcuboot_secondary": (0x49000, 0x41000, 0x20000),
+}
+B0 = (0x0, 0x8000)
+EXT_FLASH_USERSPACE = (0x61000, 0x9F000)
+FW_INFO_PARTITIONS = ("s0", "s1", "mcuboot_primary", "mcuboot_secondary")
+HEX_PARTITIONS = ("mcuboot_secondary",)
+
+
+def write_layout(path):
+    def entry(name, addr, region, size):
+        return f"{name}:\n  address: {addr:#x}\n  region: {region}\n  size: {size:#x}\n"
+
+    with open(path, "w", encoding="ascii") as f:
+        f.write(entry("b0", B0[0], "flash_primary", B0[1]))
+        for name, (int_addr, _, size) in PARTITIONS.items():
+            f.write(entry(name, int_addr, "flash_primary", size))
+        for name, (_, ext_addr, size) in PARTITIONS.items():
+            f.write(entry(f"{name}_ext", ext_addr, "external_flash", size))
+        f.write(entry("ext_flash_userspace", EXT_FLASH_USERSPACE[0], "external_flash", EXT_FLASH_USERSPACE[1]))
+
+
+def make_image(rnd, name, size, with_fw_info):
+    img = bytearray(rnd.getrandbits(8) for _ in range(size))
+    if with_fw_info:
+        int_addr = PARTITIONS[name][0]
+        fw_info = struct.pack(
+            "<IIIIIII", FW_INFO_MAGIC_COMMON, FW_INFO_MAGIC_FW_INFO, 0, size, 1, int_addr, int_addr)
+        img[FW_INFO_OFFSET:FW_INFO_OFFSET + len(fw_info)] = fw_info
+    return bytes(img)
+
+
+def write_hex(path, base_addr, data):
+    def record(rec_type, addr, payload):
+        rec = bytes([len(payload), (addr >> 8) & 0xFF, addr & 0xFF, rec_type]) + payload
+        return ":" + rec.hex().upper() + f"{(-sum(rec)) & 0xFF:02X}\n"
+
+    with open(path, "w", encoding="ascii") as f:
+        upper = None
+        for offset in range(0, len(data), 16):
+            addr = base_addr + offset
+            if (addr >> 16) != upper:
+                upper = addr >> 16
+                f.write(record(0x04, 0, struct.pack(">H", upper)))
+            f.write(record(0x00, addr & 0xFFFF, data[offset:offset + 16]))
+        f.write(record(0x01, 0, b""))
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(__doc__)
+        return 1
+    out_dir = sys.argv[1]
+    os.makedirs(out_dir, exist_ok=True)
+    write_layout(os.path.join(out_dir, "partitions.yml"))
+
+    rnd = random.Random(0xB0)
+    int_expected = bytearray(b"\xff" * INT_FLASH_SIZE)
+    for name, (int_addr, _, size) in PARTITIONS.items():
+        # Images are shorter than the partition, the rest of the partition stays erased.
+        img = make_image(rnd, name, size - 0x300, name in FW_INFO_PARTITIONS)
+        if name in HEX_PARTITIONS:
+            write_hex(os.path.join(out_dir, f"{name}.hex"), int_addr, img)
+        else:
+            with open(os.path.join(out_dir, f"{name}.bin"), "wb") as f:
+                f.write(img)
+        int_expected[int_addr:int_addr + len(img)] = img
+
+    with open(os.path.join(out_dir, "s0_bad.bin"), "wb") as f:
+        f.write(make_image(rnd, "s0", 0x1000, False))
+    with open(os.path.join(out_dir, "int_expected.bin"), "wb") as f:
+        f.write(int_expected)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())